@@ -46,8 +46,13 @@ SOURCES += \
     ../ld-chroma-decoder/framecanvas.cpp \
     dropoutanalysisdialog.cpp \
     ../ld-chroma-decoder/opticalflow.cpp \
+    ../ld-chroma-decoder/outputframelayout.cpp \
     ../ld-chroma-decoder/sourcefield.cpp \
+    ../library/tbc/jsonreader.cpp \
+    ../library/tbc/jsonwriter.cpp \
     ../library/tbc/lddecodemetadata.cpp \
+    ../library/tbc/fieldcache.cpp \
+    ../library/tbc/fieldcompressor.cpp \
     ../library/tbc/sourcevideo.cpp \
     ../library/tbc/vbidecoder.cpp
 
@@ -73,8 +78,13 @@ HEADERS += \
     dropoutanalysisdialog.h \
     ../ld-chroma-decoder/yiqbuffer.h \
     ../ld-chroma-decoder/opticalflow.h \
+    ../ld-chroma-decoder/outputframelayout.h \
     ../ld-chroma-decoder/sourcefield.h \
+    ../library/tbc/jsonreader.h \
+    ../library/tbc/jsonwriter.h \
     ../library/tbc/lddecodemetadata.h \
+    ../library/tbc/fieldcache.h \
+    ../library/tbc/fieldcompressor.h \
     ../library/tbc/sourcevideo.h \
     ../library/tbc/vbidecoder.h
 
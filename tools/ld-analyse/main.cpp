@@ -23,6 +23,7 @@
 ************************************************************************/
 
 #include "mainwindow.h"
+#include "sourcevideo.h"
 #include <QApplication>
 #include <QDebug>
 #include <QtGlobal>
@@ -94,12 +95,18 @@ int main(int argc, char *argv[])
                                        QCoreApplication::translate("main", "Show debug"));
     parser.addOption(showDebugOption);
 
+    // Option to select the field cache size (--cache)
+    SourceVideo::addCacheSizeOption(parser);
+
     // Positional argument to specify input video file
     parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file"));
 
     // Process the command line arguments given by the user
     parser.process(a);
 
+    // Set the input field cache size (if specified)
+    if (!SourceVideo::applyCacheSizeOption(parser)) return -1;
+
     // Get the configured settings from the parser
     bool isDebugOn = parser.isSet(showDebugOption);
 
@@ -26,6 +26,8 @@
 
 #include "sourcefield.h"
 
+#include <QFileInfo>
+
 TbcSource::TbcSource(QObject *parent) : QObject(parent)
 {
     // Default frame image options
@@ -328,23 +330,22 @@ TbcSource::ScanLineData TbcSource::getScanLineData(qint32 frameNumber, qint32 sc
     scanLineData.activeVideoEnd = videoParameters.activeVideoEnd;
     scanLineData.isSourcePal = videoParameters.isSourcePal;
 
-    // Get the field video and dropout data
-    QByteArray fieldData;
+    // Get the field line video and dropout data (only the required line is read)
+    SourceVideo::FieldRegion lineRegion;
     LdDecodeMetaData::DropOuts dropouts;
     if (isFieldTop) {
-        fieldData = sourceVideo.getVideoField(firstFieldNumber);
+        lineRegion = sourceVideo.getVideoFieldRegion(firstFieldNumber, fieldLine, fieldLine);
         dropouts = ldDecodeMetaData.getFieldDropOuts(firstFieldNumber);
     } else {
-        fieldData = sourceVideo.getVideoField(secondFieldNumber);
+        lineRegion = sourceVideo.getVideoFieldRegion(secondFieldNumber, fieldLine, fieldLine);
         dropouts = ldDecodeMetaData.getFieldDropOuts(secondFieldNumber);
     }
 
     scanLineData.data.resize(videoParameters.fieldWidth);
     scanLineData.isDropout.resize(videoParameters.fieldWidth);
     for (qint32 xPosition = 0; xPosition < videoParameters.fieldWidth; xPosition++) {
-        // Get the 16-bit YC value for the current pixel (frame data is numbered 0-624 or 0-524)
-        uchar *pixelPointer = reinterpret_cast<uchar*>(fieldData.data()) + ((fieldLine - 1) * videoParameters.fieldWidth * 2) + (xPosition * 2);
-        scanLineData.data[xPosition] = (pixelPointer[1] * 256) + pixelPointer[0];
+        // Get the 16-bit YC value for the current pixel
+        scanLineData.data[xPosition] = lineRegion.sample(fieldLine, xPosition);
 
         scanLineData.isDropout[xPosition] = false;
         for (qint32 doCount = 0; doCount < dropouts.startx.size(); doCount++) {
@@ -680,7 +681,7 @@ void TbcSource::startBackgroundLoad(QString sourceFilename)
         // Open the new source video
         qDebug() << "TbcSource::startBackgroundLoad(): Loading TBC file...";
         emit busyLoading("Loading TBC file...");
-        if (!sourceVideo.open(sourceFilename, videoParameters.fieldWidth * videoParameters.fieldHeight)) {
+        if (!sourceVideo.open(sourceFilename, videoParameters.fieldWidth * videoParameters.fieldHeight, videoParameters.fieldWidth)) {
             // Open failed
             qWarning() << "Open TBC file failed for filename" << sourceFilename;
             currentSourceFilename.clear();
@@ -689,6 +690,8 @@ void TbcSource::startBackgroundLoad(QString sourceFilename)
             lastLoadError = "Could not open TBC data file!";
         } else {
             // Both the video and metadata files are now open
+            // (ld-analyse jumps around the source, so disable read-ahead)
+            sourceVideo.setAccessPattern(SourceVideo::randomAccess);
             sourceReady = true;
             currentSourceFilename = sourceFilename;
         }
@@ -27,6 +27,11 @@
 
 #include "../../deemp.h"
 
+#include <algorithm>
+
+constexpr qint32 Comb::MOTION_BLOCK_WIDTH;
+constexpr qint32 Comb::MOTION_BLOCK_HEIGHT;
+
 // Public methods -----------------------------------------------------------------------------------------------------
 
 Comb::Comb()
@@ -34,6 +39,18 @@ Comb::Comb()
 {
 }
 
+Comb::~Comb()
+{
+    // Report where the time went
+    if (stageTimes.frames > 0) {
+        const qreal msPerFrame = 1.0e-6 / stageTimes.frames;
+        qDebug().nospace() << "Comb::~Comb(): " << stageTimes.frames << " frames - per frame: "
+                           << "motion detection " << stageTimes.motionNsecs * msPerFrame << " ms, "
+                           << "filtering " << stageTimes.filterNsecs * msPerFrame << " ms, "
+                           << "output " << stageTimes.outputNsecs * msPerFrame << " ms";
+    }
+}
+
 // Return the current configuration
 const Comb::Configuration &Comb::getConfiguration() const {
     return configuration;
@@ -45,6 +62,7 @@ void Comb::updateConfiguration(const LdDecodeMetaData::VideoParameters &_videoPa
     // Copy the configuration parameters
     videoParameters = _videoParameters;
     configuration = _configuration;
+    outputLayout = OutputFrameLayout::fullFrame(videoParameters);
 
     // Range check the frame dimensions
     if (videoParameters.fieldWidth > 910) qCritical() << "Comb::Comb(): Frame width exceeds allowed maximum!";
@@ -59,37 +77,55 @@ void Comb::updateConfiguration(const LdDecodeMetaData::VideoParameters &_videoPa
     // Set the frame height
     frameHeight = ((videoParameters.fieldHeight * 2) - 1);
 
+    // Allocate the buffers for the active region
+    for (ChromaBuffer &chromaBuffer: currentFrameBuffer.clpbuffer) {
+        chromaBuffer.resize(configuration.firstActiveLine, configuration.lastActiveLine, videoParameters.activeVideoEnd);
+    }
+
+    currentFrameBuffer.greyFrame.release();
+    configureMotionBlocks();
+
+    // Forget the previous frame, as it was prepared with the old parameters
+    previousFrame = PreviousFrame();
+
     configurationSet = true;
 }
 
-// Process the input buffer into the RGB output buffer
+void Comb::setOutputLayout(const OutputFrameLayout &_outputLayout)
+{
+    outputLayout = _outputLayout;
+}
+
+// Process the input buffer into a new RGB output buffer
 QByteArray Comb::decodeFrame(const SourceField &firstField, const SourceField &secondField)
+{
+    QByteArray rgbOutputBuffer;
+    decodeFrame(firstField, secondField, rgbOutputBuffer);
+
+    return rgbOutputBuffer;
+}
+
+// Add the time since timer was started to total, and restart timer
+static inline void addStageTime(QElapsedTimer &timer, qint64 &total)
+{
+    total += timer.nsecsElapsed();
+    timer.start();
+}
+
+// Process the input buffer into the RGB output buffer
+void Comb::decodeFrame(const SourceField &firstField, const SourceField &secondField, QByteArray &rgbOutputBuffer)
 {
     // Ensure the object has been configured
     if (!configurationSet) {
         qDebug() << "Comb::process(): Called, but the object has not been configured";
-        return nullptr;
+        return;
     }
 
-    // Allocate the frame buffer
-    FrameBuffer currentFrameBuffer;
-    currentFrameBuffer.clpbuffer.resize(3);
+    QElapsedTimer stageTimer;
+    stageTimer.start();
 
-    // Allocate the temporary YIQ buffer
-    YiqBuffer tempYiqBuffer;
-
-    // Allocate RGB output buffer
-    QByteArray rgbOutputBuffer;
-    QByteArray bgrBuffer;
-
-    // Interlace the input fields and place in the frame[0]'s raw buffer
-    qint32 fieldLine = 0;
-    currentFrameBuffer.rawbuffer.clear();
-    for (qint32 frameLine = 0; frameLine < frameHeight; frameLine += 2) {
-        currentFrameBuffer.rawbuffer.append(firstField.data.mid(fieldLine * videoParameters.fieldWidth * 2, videoParameters.fieldWidth * 2));
-        currentFrameBuffer.rawbuffer.append(secondField.data.mid(fieldLine * videoParameters.fieldWidth * 2, videoParameters.fieldWidth * 2));
-        fieldLine++;
-    }
+    // Interlace the input fields and place in the frame's raw buffer
+    interlaceFields(firstField, secondField, currentFrameBuffer.rawbuffer);
 
     // Set the frame's burst median (IRE) from the *first* field only.
     // This is used by yiqToRgbFrame to tweak the colour saturation levels
@@ -115,16 +151,18 @@ QByteArray Comb::decodeFrame(const SourceField &firstField, const SourceField &s
 
         // Copy the current frame to a temporary buffer, so operations on the frame do not
         // alter the original data
-        tempYiqBuffer = currentFrameBuffer.yiqBuffer;
+        copyActiveLines(currentFrameBuffer.yiqBuffer, tempYiqBuffer);
 
         // Process the copy of the current frame
         adjustY(&currentFrameBuffer, tempYiqBuffer);
         if (configuration.colorlpf) filterIQ(currentFrameBuffer.yiqBuffer);
         doYNR(tempYiqBuffer);
         doCNR(tempYiqBuffer);
+        addStageTime(stageTimer, stageTimes.filterNsecs);
 
         // Convert the YIQ result to RGB
-        rgbOutputBuffer = yiqToRgbFrame(tempYiqBuffer, currentFrameBuffer.burstLevel);
+        yiqToRgbFrame(tempYiqBuffer, currentFrameBuffer.burstLevel, rgbOutputBuffer);
+        addStageTime(stageTimer, stageTimes.outputNsecs);
     } else {
         // 3D comb filter processing
 
@@ -133,50 +171,103 @@ QByteArray Comb::decodeFrame(const SourceField &firstField, const SourceField &s
 
         // Perform 2D processing
         split2D(&currentFrameBuffer);
+        addStageTime(stageTimer, stageTimes.filterNsecs);
 
-        // Split the IQ values (populates Y)
-        splitIQ(&currentFrameBuffer);
-
-        tempYiqBuffer = currentFrameBuffer.yiqBuffer;
-
-        // Process the copy of the current frame (needed for the Y image used by the optical flow)
-        adjustY(&currentFrameBuffer, tempYiqBuffer);
-        if (configuration.colorlpf) filterIQ(currentFrameBuffer.yiqBuffer);
-        doYNR(tempYiqBuffer);
-        doCNR(tempYiqBuffer);
-
-        opticalFlow.denseOpticalFlow(currentFrameBuffer.yiqBuffer, currentFrameBuffer.kValues);
+        // Compare the current frame with the previous one to find moving pixels
+        detectMotion(&currentFrameBuffer);
+        addStageTime(stageTimer, stageTimes.motionNsecs);
 
         // Perform 3D processing
-        split3D(&currentFrameBuffer, &previousFrameBuffer);
+        split3D(&currentFrameBuffer, previousFrame.rawbuffer);
 
         // Split the IQ values
         splitIQ(&currentFrameBuffer);
 
-        tempYiqBuffer = currentFrameBuffer.yiqBuffer;
+        copyActiveLines(currentFrameBuffer.yiqBuffer, tempYiqBuffer);
 
         // Process the copy of the current frame (for final output now flow detection has been performed)
         adjustY(&currentFrameBuffer, tempYiqBuffer);
         if (configuration.colorlpf) filterIQ(currentFrameBuffer.yiqBuffer);
         doYNR(tempYiqBuffer);
         doCNR(tempYiqBuffer);
+        addStageTime(stageTimer, stageTimes.filterNsecs);
 
         // Convert the YIQ result to RGB
-        rgbOutputBuffer = yiqToRgbFrame(tempYiqBuffer, currentFrameBuffer.burstLevel);
+        yiqToRgbFrame(tempYiqBuffer, currentFrameBuffer.burstLevel, rgbOutputBuffer);
 
         // Overlay the optical flow map if required
         if (configuration.showOpticalFlowMap) overlayOpticalFlowMap(currentFrameBuffer, rgbOutputBuffer);
+        addStageTime(stageTimer, stageTimes.outputNsecs);
 
-        // Store the current frame
-        previousFrameBuffer = currentFrameBuffer;
+        // Keep the parts of the current frame needed to decode the next one
+        // (swapping buffers with the old previous frame, to be reused)
+        previousFrame.frameNumber = firstField.frameNumber;
+        previousFrame.rawbuffer.swap(currentFrameBuffer.rawbuffer);
+        cv::swap(previousFrame.greyFrame, currentFrameBuffer.greyFrame);
     }
 
-    // Return the output frame
-    return rgbOutputBuffer;
+    stageTimes.frames++;
+}
+
+void Comb::loadPreviousFrame(const SourceField &firstField, const SourceField &secondField)
+{
+    // Only 3D processing uses the previous frame
+    if (!configurationSet || !configuration.use3D) return;
+
+    // Is this the frame that was decoded last?
+    if (firstField.frameNumber != -1 && firstField.frameNumber == previousFrame.frameNumber) return;
+
+    previousFrame.frameNumber = firstField.frameNumber;
+    interlaceFields(firstField, secondField, previousFrame.rawbuffer);
+    if (configuration.motionMode == opticalFlowMode) makeGreyFrame(previousFrame.rawbuffer, previousFrame.greyFrame);
 }
 
 // Private methods ----------------------------------------------------------------------------------------------------
 
+// Interlace two input fields into a frame of raw samples
+void Comb::interlaceFields(const SourceField &firstField, const SourceField &secondField, QByteArray &rawbuffer)
+{
+    const qint32 lineBytes = videoParameters.fieldWidth * 2;
+
+    rawbuffer.resize(lineBytes * (frameHeight + 1));
+    char *out = rawbuffer.data();
+    qint32 fieldLine = 0;
+    for (qint32 frameLine = 0; frameLine < frameHeight; frameLine += 2) {
+        memcpy(out, firstField.data.constData() + (fieldLine * lineBytes), lineBytes);
+        out += lineBytes;
+        memcpy(out, secondField.data.constData() + (fieldLine * lineBytes), lineBytes);
+        out += lineBytes;
+        fieldLine++;
+    }
+}
+
+// Make the greyscale image used by the optical flow analysis from a frame of
+// raw samples.  This uses the composite signal within the active region as
+// the luma (as the 2D Y would be the same).  The image covers just the active
+// region, surrounded by the black border that OpticalFlow needs.
+void Comb::makeGreyFrame(const QByteArray &rawbuffer, cv::Mat &greyFrame)
+{
+    const qint32 activeWidth = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
+    const qint32 activeHeight = configuration.lastActiveLine - configuration.firstActiveLine;
+    const qint32 border = OpticalFlow::BORDER;
+
+    // Allocate the image if necessary.  Only the active region is written,
+    // so the border stays black when the image is reused
+    if (greyFrame.rows != activeHeight + (2 * border) || greyFrame.cols != activeWidth + (2 * border)) {
+        greyFrame = cv::Mat::zeros(activeHeight + (2 * border), activeWidth + (2 * border), CV_8UC1);
+    }
+
+    for (qint32 y = 0; y < activeHeight; y++) {
+        const quint16 *line = reinterpret_cast<const quint16 *>(rawbuffer.constData() + ((configuration.firstActiveLine + y) * videoParameters.fieldWidth) * 2)
+                              + videoParameters.activeVideoStart;
+        quint8 *outLine = greyFrame.ptr<quint8>(y + border) + border;
+
+        for (qint32 x = 0; x < activeWidth; x++) {
+            outLine[x] = static_cast<quint8>(line[x] >> 8);
+        }
+    }
+}
+
 /* 
  * The color burst frequency is 227.5 cycles per line, so it flips 180 degrees for each line.
  * 
@@ -212,14 +303,15 @@ inline bool Comb::GetLinePhase(FrameBuffer *frameBuffer, qint32 lineNumber)
 void Comb::split1D(FrameBuffer *frameBuffer)
 {
     for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
-        // Get a pointer to the line's data
-        quint16 *line = reinterpret_cast<quint16 *>(frameBuffer->rawbuffer.data() + (lineNumber * videoParameters.fieldWidth) * 2);
+        // Get pointers to the line's data
+        const quint16 *line = reinterpret_cast<const quint16 *>(frameBuffer->rawbuffer.constData() + (lineNumber * videoParameters.fieldWidth) * 2);
+        float *outLine = frameBuffer->clpbuffer[0].line(lineNumber);
 
         for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
             qreal tc1 = (((line[h + 2] + line[h - 2]) / 2) - line[h]);
 
             // Record the 1D C value
-            frameBuffer->clpbuffer[0].pixel[lineNumber][h] = tc1;
+            outLine[h] = tc1;
         }
     }
 }
@@ -228,129 +320,324 @@ void Comb::split1D(FrameBuffer *frameBuffer)
 void Comb::split2D(FrameBuffer *frameBuffer)
 {
     // Dummy black line.
-    static constexpr qreal blackLine[911] = {0};
+    static constexpr float blackLine[911] = {0};
+
+    // Range of differences between lines that are treated as similar
+    const qreal p_2drange = 45 * irescale;
 
     for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
         // Get pointers to the surrounding lines.
         // If a line we need is outside the active area, use blackLine instead.
-        const qreal *previousLine = blackLine;
+        const float *previousLine = blackLine;
         if (lineNumber - 2 >= configuration.firstActiveLine) {
-            previousLine = frameBuffer->clpbuffer[0].pixel[lineNumber - 2];
+            previousLine = frameBuffer->clpbuffer[0].line(lineNumber - 2);
         }
-        const qreal *currentLine = frameBuffer->clpbuffer[0].pixel[lineNumber];
-        const qreal *nextLine = blackLine;
+        const float *currentLine = frameBuffer->clpbuffer[0].line(lineNumber);
+        const float *nextLine = blackLine;
         if (lineNumber + 2 < configuration.lastActiveLine) {
-            nextLine = frameBuffer->clpbuffer[0].pixel[lineNumber + 2];
+            nextLine = frameBuffer->clpbuffer[0].line(lineNumber + 2);
         }
 
+        float *outLine = frameBuffer->clpbuffer[1].line(lineNumber);
+
         // 2D filtering.
+        // The choice of neighbours below is made with selects rather than
+        // nested branches, so the compiler can vectorise the loop
         for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            qreal tc1;
+            const qreal absCurrent = fabs(currentLine[h]);
+            const qreal absCurrentLeft = fabs(currentLine[h - 1]);
+            const qreal absPrevious = fabs(previousLine[h]);
+            const qreal absNext = fabs(nextLine[h]);
 
             qreal kp, kn;
 
-            kp  = fabs(fabs(currentLine[h]) - fabs(previousLine[h])); // - fabs(c1line[h] * .20);
-            kp += fabs(fabs(currentLine[h - 1]) - fabs(previousLine[h - 1]));
-            kp -= (fabs(currentLine[h]) + fabs(currentLine[h - 1])) * .10;
-            kn  = fabs(fabs(currentLine[h]) - fabs(nextLine[h])); // - fabs(c1line[h] * .20);
-            kn += fabs(fabs(currentLine[h - 1]) - fabs(nextLine[h - 1]));
-            kn -= (fabs(currentLine[h]) + fabs(nextLine[h - 1])) * .10;
+            kp  = fabs(absCurrent - absPrevious); // - fabs(c1line[h] * .20);
+            kp += fabs(absCurrentLeft - fabs(previousLine[h - 1]));
+            kp -= (absCurrent + absCurrentLeft) * .10;
+            kn  = fabs(absCurrent - absNext); // - fabs(c1line[h] * .20);
+            kn += fabs(absCurrentLeft - fabs(nextLine[h - 1]));
+            kn -= (absCurrent + fabs(nextLine[h - 1])) * .10;
 
             kp /= 2;
             kn /= 2;
 
-            qreal p_2drange = 45 * irescale;
             kp = qBound(0.0, 1 - (kp / p_2drange), 1.0);
             kn = qBound(0.0, 1 - (kn / p_2drange), 1.0);
 
-            qreal sc = 1.0;
+            // If either neighbour is similar, use the more similar neighbour
+            // if one is much more similar than the other.  (kn and kp are
+            // never both dominant, as neither is negative.)
+            const qreal kpSimilar = (kn > (3 * kp)) ? 0.0 : kp;
+            const qreal knSimilar = (kp > (3 * kn)) ? 0.0 : kn;
+            // This is infinite if neither is similar, but then it isn't used
+            const qreal scSimilar = qMax(2.0 / (knSimilar + kpSimilar), 1.0);// * max(kn * kn, kp * kp);
 
-            if ((kn > 0) || (kp > 0)) {
-                if (kn > (3 * kp)) kp = 0;
-                else if (kp > (3 * kn)) kn = 0;
+            // If neither neighbour is similar, use both if they are similar to each other
+            const qreal kFlat = ((fabs(absPrevious - absNext) - fabs((nextLine[h] + previousLine[h]) * .2)) <= 0) ? 1.0 : 0.0;
 
-                sc = (2.0 / (kn + kp));// * max(kn * kn, kp * kp);
-                if (sc < 1.0) sc = 1.0;
-            } else {
-                if ((fabs(fabs(previousLine[h]) - fabs(nextLine[h])) - fabs((nextLine[h] + previousLine[h]) * .2)) <= 0) {
-                    kn = kp = 1;
-                }
-            }
+            // Either is similar if their sum is non-zero
+            const qreal kSum = kn + kp;
+            kp = (kSum > 0) ? kpSimilar : kFlat;
+            kn = (kSum > 0) ? knSimilar : kFlat;
+            const qreal sc = (kSum > 0) ? scSimilar : 1.0;
 
-            tc1  = ((frameBuffer->clpbuffer[0].pixel[lineNumber][h] - previousLine[h]) * kp * sc);
-            tc1 += ((frameBuffer->clpbuffer[0].pixel[lineNumber][h] - nextLine[h]) * kn * sc);
+            qreal tc1;
+            tc1  = ((currentLine[h] - previousLine[h]) * kp * sc);
+            tc1 += ((currentLine[h] - nextLine[h]) * kn * sc);
             tc1 /= 8; //(2 * 2);
 
             // Record the 2D C value
-            frameBuffer->clpbuffer[1].pixel[lineNumber][h] = tc1;
+            outLine[h] = tc1;
         }
     }
 }
 
 // This could do with an explaination of what it is doing...
 // Only apply 3D processing to stationary pixels
-void Comb::split3D(FrameBuffer *currentFrame, FrameBuffer *previousFrame)
+void Comb::split3D(FrameBuffer *currentFrame, const QByteArray &previousRawbuffer)
 {
     // If there is no previous frame data (i.e. this is the first frame), use the current frame.
-    if (previousFrame->rawbuffer.size() == 0) {
-        previousFrame = currentFrame;
-    }
+    const QByteArray &previousFrameData = previousRawbuffer.isEmpty() ? currentFrame->rawbuffer : previousRawbuffer;
 
     for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
 
         quint16 *currentLine = reinterpret_cast<quint16 *>(currentFrame->rawbuffer.data() + (lineNumber * videoParameters.fieldWidth) * 2);
-        quint16 *previousLine = reinterpret_cast<quint16 *>(previousFrame->rawbuffer.data() + (lineNumber * videoParameters.fieldWidth) * 2);
+        const quint16 *previousLine = reinterpret_cast<const quint16 *>(previousFrameData.constData() + (lineNumber * videoParameters.fieldWidth) * 2);
+        float *outLine = currentFrame->clpbuffer[2].line(lineNumber);
 
         for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            currentFrame->clpbuffer[2].pixel[lineNumber][h] = (previousLine[h] - currentLine[h]) / 2;
+            outLine[h] = (previousLine[h] - currentLine[h]) / 2;
         }
     }
 }
 
-// Spilt the I and Q
-void Comb::splitIQ(FrameBuffer *frameBuffer)
+// Fill in the frame's kValues (0 for stationary pixels to 1 for moving
+// pixels) by comparing it with the previous frame.  If the optical flow is
+// used, this also makes the frame's greyscale image.
+void Comb::detectMotion(FrameBuffer *frameBuffer)
 {
-    // Clear the target frame YIQ buffer
-    frameBuffer->yiqBuffer.clear();
+    if (configuration.motionMode == opticalFlowMode) {
+        makeGreyFrame(frameBuffer->rawbuffer, frameBuffer->greyFrame);
+    }
 
-    for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
-        // Get a pointer to the line's data
-        quint16 *line = reinterpret_cast<quint16 *>(frameBuffer->rawbuffer.data() + (lineNumber * videoParameters.fieldWidth) * 2);
-        bool linePhase = GetLinePhase(frameBuffer, lineNumber);
+    if (previousFrame.rawbuffer.isEmpty()) {
+        // There is no previous frame, so treat every pixel as moving (so only
+        // 2D processing is used)
+        frameBuffer->kValues.fill(1.0f, getKIndex(videoParameters.activeVideoStart, configuration.lastActiveLine));
+    } else if (configuration.motionMode == opticalFlowMode) {
+        opticalFlow.denseOpticalFlow(previousFrame.greyFrame, frameBuffer->greyFrame, frameBuffer->kValues);
+    } else {
+        detectMotionByDifference(frameBuffer, previousFrame.rawbuffer);
+    }
+}
 
-        qreal si = 0, sq = 0;
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            qint32 phase = h % 4;
+// Allocate the buffers used by detectMotionByDifference, and fill in the
+// parts that depend only on the configuration
+void Comb::configureMotionBlocks()
+{
+    const qint32 firstLine = configuration.firstActiveLine;
+    const qint32 lastLine = configuration.lastActiveLine;
+    const qint32 firstSample = videoParameters.activeVideoStart;
+    const qint32 lastSample = videoParameters.activeVideoEnd;
+    const qint32 blocksWide = ((lastSample - firstSample) + MOTION_BLOCK_WIDTH - 1) / MOTION_BLOCK_WIDTH;
+    const qint32 blocksHigh = ((lastLine - firstLine) + MOTION_BLOCK_HEIGHT - 1) / MOTION_BLOCK_HEIGHT;
+
+    motionBlocks.blocksWide = blocksWide;
+    motionBlocks.blocksHigh = blocksHigh;
+    motionBlocks.sums.resize(blocksWide * blocksHigh);
+    motionBlocks.k.resize(blocksWide * blocksHigh);
+    motionBlocks.spreadK.resize(blocksWide * blocksHigh);
+
+    // Count the samples in each block (the blocks at the right and bottom
+    // edges may be partial)
+    motionBlocks.counts.fill(0, blocksWide * blocksHigh);
+    for (qint32 lineNumber = firstLine; lineNumber < lastLine; lineNumber++) {
+        const qint32 blockRow = ((lineNumber - firstLine) / MOTION_BLOCK_HEIGHT) * blocksWide;
+
+        for (qint32 blockX = 0; blockX < blocksWide; blockX++) {
+            const qint32 blockStart = firstSample + (blockX * MOTION_BLOCK_WIDTH);
+            const qint32 blockEnd = qMin(blockStart + MOTION_BLOCK_WIDTH, lastSample);
+            motionBlocks.counts[blockRow + blockX] += blockEnd - blockStart;
+        }
+    }
 
-            // Take the 2D C
-            qreal cavg = frameBuffer->clpbuffer[1].pixel[lineNumber][h]; // 2D C average
+    // Work out which blocks each sample is interpolated between
+    motionBlocks.leftBlock.resize(lastSample);
+    motionBlocks.rightBlock.resize(lastSample);
+    motionBlocks.xWeight.resize(lastSample);
+    for (qint32 h = firstSample; h < lastSample; h++) {
+        const qreal position = qBound(0.0, ((h - firstSample) + 0.5) / MOTION_BLOCK_WIDTH - 0.5, blocksWide - 1.0);
+        motionBlocks.leftBlock[h] = static_cast<qint32>(position);
+        motionBlocks.rightBlock[h] = qMin(motionBlocks.leftBlock[h] + 1, blocksWide - 1);
+        motionBlocks.xWeight[h] = static_cast<float>(position - motionBlocks.leftBlock[h]);
+    }
+}
 
-            if (configuration.use3D && frameBuffer->kValues.size() != 0) {
-                // The motionK map returns K (0 for stationary pixels to 1 for moving pixels)
-                cavg  = frameBuffer->clpbuffer[1].pixel[lineNumber][h] * frameBuffer->kValues[(lineNumber * 910) + h]; // 2D mix
-                cavg += frameBuffer->clpbuffer[2].pixel[lineNumber][h] * (1 - frameBuffer->kValues[(lineNumber * 910) + h]); // 3D mix
+// Detect motion from the difference between the luma of the current and
+// previous frames.
+//
+// The luma is found with a [1 2 1] filter across samples two apart, which
+// cancels out the chroma.  The absolute differences are averaged over
+// blocks, and each block's average is mapped to a K value between two
+// thresholds.  Each block then takes the largest K of its neighbours, so
+// that the edges of moving areas are treated as moving, and the block
+// values are interpolated to give a smooth K map.
+void Comb::detectMotionByDifference(FrameBuffer *frameBuffer, const QByteArray &previousRawbuffer)
+{
+    // Average luma differences (in IRE) below which a block is stationary,
+    // and above which it is moving
+    static constexpr qreal STATIONARY_LEVEL = 1.5;
+    static constexpr qreal MOVING_LEVEL = 5.0;
+
+    const qint32 firstLine = configuration.firstActiveLine;
+    const qint32 lastLine = configuration.lastActiveLine;
+    const qint32 firstSample = videoParameters.activeVideoStart;
+    const qint32 lastSample = videoParameters.activeVideoEnd;
+    const qint32 blocksWide = motionBlocks.blocksWide;
+    const qint32 blocksHigh = motionBlocks.blocksHigh;
+
+    // Sum the absolute luma differences in each block.  The luma values are
+    // 4 times the real luma, to keep the arithmetic in integers
+    qint64 *blockSums = motionBlocks.sums.data();
+    std::fill_n(blockSums, motionBlocks.sums.size(), 0);
+    for (qint32 lineNumber = firstLine; lineNumber < lastLine; lineNumber++) {
+        const quint16 *currentLine = reinterpret_cast<const quint16 *>(frameBuffer->rawbuffer.constData() + (lineNumber * videoParameters.fieldWidth) * 2);
+        const quint16 *previousLine = reinterpret_cast<const quint16 *>(previousRawbuffer.constData() + (lineNumber * videoParameters.fieldWidth) * 2);
+        const qint32 blockRow = ((lineNumber - firstLine) / MOTION_BLOCK_HEIGHT) * blocksWide;
+
+        for (qint32 blockX = 0; blockX < blocksWide; blockX++) {
+            const qint32 blockStart = firstSample + (blockX * MOTION_BLOCK_WIDTH);
+            const qint32 blockEnd = qMin(blockStart + MOTION_BLOCK_WIDTH, lastSample);
+
+            qint32 sum = 0;
+            for (qint32 h = blockStart; h < blockEnd; h++) {
+                const qint32 currentLuma = currentLine[h - 2] + (2 * currentLine[h]) + currentLine[h + 2];
+                const qint32 previousLuma = previousLine[h - 2] + (2 * previousLine[h]) + previousLine[h + 2];
+                sum += qAbs(currentLuma - previousLuma);
+            }
 
-                // Use only 3D (for testing!)
-                //cavg = frameBuffer->clpbuffer[2].pixel[lineNumber][h];
+            blockSums[blockRow + blockX] += sum;
+        }
+    }
+
+    // Convert each block's average difference to a K value
+    const qreal stationaryLevel = STATIONARY_LEVEL * irescale;
+    const qreal movingLevel = MOVING_LEVEL * irescale;
+    const qint32 *blockCounts = motionBlocks.counts.constData();
+    float *blockK = motionBlocks.k.data();
+    for (qint32 i = 0; i < motionBlocks.k.size(); i++) {
+        const qreal difference = static_cast<qreal>(blockSums[i]) / (blockCounts[i] * 4);
+        blockK[i] = static_cast<float>(qBound(0.0, (difference - stationaryLevel) / (movingLevel - stationaryLevel), 1.0));
+    }
+
+    // Spread motion into the neighbouring blocks
+    float *spreadK = motionBlocks.spreadK.data();
+    for (qint32 blockY = 0; blockY < blocksHigh; blockY++) {
+        for (qint32 blockX = 0; blockX < blocksWide; blockX++) {
+            float k = 0.0f;
+            for (qint32 y = qMax(blockY - 1, 0); y <= qMin(blockY + 1, blocksHigh - 1); y++) {
+                for (qint32 x = qMax(blockX - 1, 0); x <= qMin(blockX + 1, blocksWide - 1); x++) {
+                    k = qMax(k, blockK[(y * blocksWide) + x]);
+                }
             }
+            spreadK[(blockY * blocksWide) + blockX] = k;
+        }
+    }
 
-            if (!linePhase) cavg = -cavg;
+    // Interpolate between the centres of the blocks to get the K map
+    frameBuffer->kValues.resize(getKIndex(firstSample, lastLine));
+    const qint32 *leftBlock = motionBlocks.leftBlock.constData();
+    const qint32 *rightBlock = motionBlocks.rightBlock.constData();
+    const float *xWeight = motionBlocks.xWeight.constData();
+    for (qint32 lineNumber = firstLine; lineNumber < lastLine; lineNumber++) {
+        const qreal position = qBound(0.0, ((lineNumber - firstLine) + 0.5) / MOTION_BLOCK_HEIGHT - 0.5, blocksHigh - 1.0);
+        const qint32 topBlock = static_cast<qint32>(position);
+        const qint32 bottomBlock = qMin(topBlock + 1, blocksHigh - 1);
+        const float yWeight = static_cast<float>(position - topBlock);
+        const float *topRow = spreadK + (topBlock * blocksWide);
+        const float *bottomRow = spreadK + (bottomBlock * blocksWide);
+        float *kLine = frameBuffer->kValues.data() + getKIndex(firstSample, lineNumber);
+
+        for (qint32 h = firstSample; h < lastSample; h++) {
+            const float top = topRow[leftBlock[h]] + ((topRow[rightBlock[h]] - topRow[leftBlock[h]]) * xWeight[h]);
+            const float bottom = bottomRow[leftBlock[h]] + ((bottomRow[rightBlock[h]] - bottomRow[leftBlock[h]]) * xWeight[h]);
+            kLine[h - firstSample] = top + ((bottom - top) * yWeight);
+        }
+    }
+}
+
+// Spilt the I and Q
+//
+// The chroma samples alternate Q, I, -Q, -I (or the opposite, depending on
+// the line's phase), and each output pixel takes the most recent I and Q
+// samples.  This is expressed as weights for the current and previous
+// samples, repeating every four pixels, so there is no dependency between
+// pixels and the loop can be vectorised.
+void Comb::splitIQ(FrameBuffer *frameBuffer)
+{
+    // Weights for the current and previous chroma samples, by h % 4
+    static constexpr qreal iCurrent[4]  = { 0.0, -1.0,  0.0, 1.0 };
+    static constexpr qreal iPrevious[4] = { 1.0,  0.0, -1.0, 0.0 };
+    static constexpr qreal qCurrent[4]  = { 1.0,  0.0, -1.0, 0.0 };
+    static constexpr qreal qPrevious[4] = { 0.0,  1.0,  0.0, -1.0 };
+
+    const bool useKValues = configuration.use3D && frameBuffer->kValues.size() != 0;
+
+    // Chroma samples for the line, with the line phase applied.  The sample
+    // before the active region is 0, as both I and Q start at 0
+    qreal chromaBuffer[911 + 1];
+    qreal *chroma = chromaBuffer + 1;
+
+    for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
+        // Get pointers to the line's data
+        const quint16 *line = reinterpret_cast<const quint16 *>(frameBuffer->rawbuffer.constData() + (lineNumber * videoParameters.fieldWidth) * 2);
+        const float *clp2D = frameBuffer->clpbuffer[1].line(lineNumber);
+        const float *clp3D = frameBuffer->clpbuffer[2].line(lineNumber);
+        const float *kLine = useKValues ? frameBuffer->kValues.constData() + getKIndex(videoParameters.activeVideoStart, lineNumber) : nullptr;
+        YiqLine &yiqLine = frameBuffer->yiqBuffer[lineNumber];
+        const qreal phaseSign = GetLinePhase(frameBuffer, lineNumber) ? 1.0 : -1.0;
+
+        // Clear the target line (only the active lines are ever used)
+        yiqLine.fill(YIQ());
+
+        chroma[videoParameters.activeVideoStart - 1] = 0.0;
+        if (useKValues) {
+            // The motionK map returns K (0 for stationary pixels to 1 for moving pixels)
+            for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                const float k = kLine[h - videoParameters.activeVideoStart];
+                qreal cavg  = clp2D[h] * k; // 2D mix
+                cavg += clp3D[h] * (1 - k); // 3D mix
+
+                // Use only 3D (for testing!)
+                //cavg = clp3D[h];
 
-            switch (phase) {
-                case 0: sq = cavg; break;
-                case 1: si = -cavg; break;
-                case 2: sq = -cavg; break;
-                case 3: si = cavg; break;
-                default: break;
+                chroma[h] = cavg * phaseSign;
+            }
+        } else {
+            // Take the 2D C
+            for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                chroma[h] = clp2D[h] * phaseSign;
             }
+        }
+
+        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+            const qint32 phase = h % 4;
 
-            frameBuffer->yiqBuffer[lineNumber][h].y = line[h];
-            frameBuffer->yiqBuffer[lineNumber][h].i = si;
-            frameBuffer->yiqBuffer[lineNumber][h].q = sq;
+            yiqLine[h].y = line[h];
+            yiqLine[h].i = (chroma[h] * iCurrent[phase]) + (chroma[h - 1] * iPrevious[phase]);
+            yiqLine[h].q = (chroma[h] * qCurrent[phase]) + (chroma[h - 1] * qPrevious[phase]);
         }
     }
 }
 
+// Copy the active lines of a YIQ buffer (the other lines are never used)
+void Comb::copyActiveLines(const YiqBuffer &source, YiqBuffer &destination)
+{
+    for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
+        destination[lineNumber] = source[lineNumber];
+    }
+}
+
 // Filter the IQ from the input YIQ buffer
 void Comb::filterIQ(YiqBuffer &yiqBuffer)
 {
@@ -364,20 +651,15 @@ void Comb::filterIQ(YiqBuffer &yiqBuffer)
         qint32 qoffset = 2; // f_colorlpf_hq ? f_colorlpi_offset : f_colorlpq_offset;
 
         qreal filti = 0, filtq = 0;
+        YiqLine &yiqLine = yiqBuffer[lineNumber];
 
         for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            qint32 phase = h % 4;
-
-            switch (phase) {
-                case 0: filti = iFilter.feed(yiqBuffer[lineNumber][h].i); break;
-                case 1: filtq = qFilter.feed(yiqBuffer[lineNumber][h].q); break;
-                case 2: filti = iFilter.feed(yiqBuffer[lineNumber][h].i); break;
-                case 3: filtq = qFilter.feed(yiqBuffer[lineNumber][h].q); break;
-                default: break;
-            }
+            // I samples are on even pixels, Q samples on odd pixels
+            if ((h % 2) == 0) filti = iFilter.feed(yiqLine[h].i);
+            else filtq = qFilter.feed(yiqLine[h].q);
 
-            yiqBuffer[lineNumber][h - qoffset].i = filti;
-            yiqBuffer[lineNumber][h - qoffset].q = filtq;
+            yiqLine[h - qoffset].i = filti;
+            yiqLine[h - qoffset].q = filtq;
         }
     }
 }
@@ -463,37 +745,41 @@ void Comb::doYNR(YiqBuffer &yiqBuffer)
     }
 }
 
-// Convert buffer from YIQ to RGB 16-16-16
-QByteArray Comb::yiqToRgbFrame(const YiqBuffer &yiqBuffer, qreal burstLevel)
+// Convert buffer from YIQ to RGB 16-16-16 (or the output layout's pixel format)
+void Comb::yiqToRgbFrame(const YiqBuffer &yiqBuffer, qreal burstLevel, QByteArray &rgbOutputFrame)
 {
-    QByteArray rgbOutputFrame;
-    rgbOutputFrame.resize((videoParameters.fieldWidth * frameHeight * 3) * 2); // * 3 * 2 for RGB 16-16-16)
-
-    // Initialise the output frame
-    rgbOutputFrame.fill(0);
+    // Prepare the output frame (only the active area will be written)
+    outputLayout.prepareFrame(rgbOutputFrame);
 
     // Initialise YIQ to RGB converter
     RGB rgb(videoParameters.white16bIre, videoParameters.black16bIre, configuration.whitePoint100, configuration.blackAndWhite, burstLevel);
 
-    // Perform YIQ to RGB conversion
-    for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
-        // Map the QByteArray data to an unsigned 16 bit pointer
-        quint16 *linePointer = reinterpret_cast<quint16 *>(rgbOutputFrame.data() + ((videoParameters.fieldWidth * 3 * lineNumber) * 2));
-
-        // Offset the output by the activeVideoStart to keep the output frame
-        // in the same x position as the input video frame (the +6 realigns the output
-        // to the source frame; not sure where the 2 pixel offset is coming from, but
-        // it's really not important)
-        qint32 o = (videoParameters.activeVideoStart * 3) + 6;
-
-        // Fill the output line with the RGB values
-        rgb.convertLine(&yiqBuffer[lineNumber][videoParameters.activeVideoStart],
-                        &yiqBuffer[lineNumber][videoParameters.activeVideoEnd],
-                        &linePointer[o]);
+    // Offset the output by the activeVideoStart to keep the output frame
+    // in the same x position as the input video frame (the +2 realigns the output
+    // to the source frame; not sure where the 2 pixel offset is coming from, but
+    // it's really not important).  Pixels that would fall outside the output
+    // frame are not converted.
+    const qint32 outputStart = videoParameters.activeVideoStart + 2;
+    const qint32 outputEnd = qMin(videoParameters.activeVideoEnd + 2, outputLayout.left + outputLayout.width);
+
+    if (outputLayout.pixelFormat == OutputFrameLayout::RGB48) {
+        // Perform YIQ to RGB conversion
+        for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
+            // Fill the output line with the RGB values
+            rgb.convertLine(&yiqBuffer[lineNumber][outputStart - 2],
+                            &yiqBuffer[lineNumber][outputEnd - 2],
+                            outputLayout.getPixel(rgbOutputFrame, outputStart, lineNumber));
+        }
+    } else {
+        // Perform YIQ to YUV conversion, and let the output layout pack it
+        double yLine[911], uLine[911], vLine[911];
+        for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
+            rgb.convertLineToYUV(&yiqBuffer[lineNumber][outputStart - 2],
+                                 &yiqBuffer[lineNumber][outputEnd - 2],
+                                 yLine, uLine, vLine);
+            outputLayout.putLine(rgbOutputFrame, outputStart, lineNumber, outputEnd - outputStart, yLine, uLine, vLine);
+        }
     }
-
-    // Return the RGB frame data
-    return rgbOutputFrame;
 }
 
 // Convert buffer from YIQ to RGB
@@ -505,24 +791,25 @@ void Comb::overlayOpticalFlowMap(const FrameBuffer &frameBuffer, QByteArray &rgb
 
     // Overlay the optical flow map on the output RGB
     for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
-        // Map the QByteArray data to an unsigned 16 bit pointer
-        quint16 *linePointer = reinterpret_cast<quint16 *>(rgbFrame.data() + ((videoParameters.fieldWidth * 3 * lineNumber) * 2));
+        // Map the QByteArray data to an unsigned 16 bit pointer (pointing at the start of the active region)
+        quint16 *linePointer = outputLayout.getPixel(rgbFrame, videoParameters.activeVideoStart, lineNumber);
 
         // Fill the output frame with the RGB values
         for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            qint32 intensity = static_cast<qint32>(frameBuffer.kValues[(lineNumber * 910) + h] * 65535);
+            qint32 intensity = static_cast<qint32>(frameBuffer.kValues[getKIndex(h, lineNumber)] * 65535);
+            const qint32 pp = (h - videoParameters.activeVideoStart) * 3;
             // Make the RGB more purple to show where motion was detected
-            qint32 red = linePointer[(h * 3)] + intensity;
-            qint32 green = linePointer[(h * 3) + 1];
-            qint32 blue = linePointer[(h * 3) + 2] + intensity;
+            qint32 red = linePointer[pp] + intensity;
+            qint32 green = linePointer[pp + 1];
+            qint32 blue = linePointer[pp + 2] + intensity;
 
             if (red > 65535) red = 65535;
             if (green > 65535) green = 65535;
             if (blue > 65535) blue = 65535;
 
-            linePointer[(h * 3)] = static_cast<quint16>(red);
-            linePointer[(h * 3) + 1] = static_cast<quint16>(green);
-            linePointer[(h * 3) + 2] = static_cast<quint16>(blue);
+            linePointer[pp] = static_cast<quint16>(red);
+            linePointer[pp + 1] = static_cast<quint16>(green);
+            linePointer[pp + 2] = static_cast<quint16>(blue);
         }
     }
 }
@@ -530,28 +817,24 @@ void Comb::overlayOpticalFlowMap(const FrameBuffer &frameBuffer, QByteArray &rgb
 // Remove the colour data from the baseband (Y)
 void Comb::adjustY(FrameBuffer *frameBuffer, YiqBuffer &yiqBuffer)
 {
+    // Weights for I and Q in the chroma signal, by h % 4
+    static constexpr qreal iWeight[4] = { 0.0, -1.0,  0.0, 1.0 };
+    static constexpr qreal qWeight[4] = { 1.0,  0.0, -1.0, 0.0 };
+
     // remove color data from baseband (Y)
     for (qint32 lineNumber = configuration.firstActiveLine; lineNumber < configuration.lastActiveLine; lineNumber++) {
-        bool linePhase = GetLinePhase(frameBuffer, lineNumber);
+        YiqLine &yiqLine = yiqBuffer[lineNumber];
+        const qreal phaseSign = GetLinePhase(frameBuffer, lineNumber) ? -1.0 : 1.0;
 
         for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            qreal comp = 0;
-            qint32 phase = h % 4;
-
-            YIQ y = yiqBuffer[lineNumber][h + 2];
+            const qint32 phase = h % 4;
 
-            switch (phase) {
-                case 0: comp = y.q; break;
-                case 1: comp = -y.i; break;
-                case 2: comp = -y.q; break;
-                case 3: comp = y.i; break;
-                default: break;
-            }
+            YIQ y = yiqLine[h + 2];
 
-            if (linePhase) comp = -comp;
+            const qreal comp = ((y.i * iWeight[phase]) + (y.q * qWeight[phase])) * phaseSign;
             y.y += comp;
 
-            yiqBuffer[lineNumber][h + 0] = y;
+            yiqLine[h + 0] = y;
         }
     }
 }
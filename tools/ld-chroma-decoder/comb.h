@@ -28,12 +28,15 @@
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QVector>
 #include <QtMath>
 
 #include "lddecodemetadata.h"
 
 #include "opticalflow.h"
+#include "outputframelayout.h"
 #include "rgb.h"
 #include "sourcefield.h"
 #include "yiq.h"
@@ -49,6 +52,15 @@ class Comb
 {
 public:
     Comb();
+    ~Comb();
+
+    // How the 3D filter detects moving parts of the picture
+    enum MotionMode {
+        // Dense optical flow between frames (accurate, but slow)
+        opticalFlowMode = 0,
+        // Luma difference between frames, in blocks (fast, but coarse)
+        frameDifferenceMode
+    };
 
     // Comb filter configuration parameters
     struct Configuration {
@@ -57,6 +69,7 @@ public:
         bool colorlpf_hq = true;
         bool whitePoint100 = false;
         bool use3D = false;
+        MotionMode motionMode = opticalFlowMode;
         bool showOpticalFlowMap = false;
 
         // Interlaced line 40 is NTSC line 21 (the closed-caption line before the first active half-line)
@@ -72,9 +85,23 @@ public:
     void updateConfiguration(const LdDecodeMetaData::VideoParameters &videoParameters,
                              const Configuration &configuration);
 
+    // Set the layout of the output frames.  updateConfiguration sets this to
+    // the full frame.
+    void setOutputLayout(const OutputFrameLayout &outputLayout);
+
     // Decode two fields to produce an interlaced frame.
     QByteArray decodeFrame(const SourceField &firstField, const SourceField &secondField);
 
+    // Decode two fields into outputFrame, which may contain a frame
+    // previously decoded with the same layout (and will be reused if so).
+    void decodeFrame(const SourceField &firstField, const SourceField &secondField, QByteArray &outputFrame);
+
+    // Supply the frame before the next one to be decoded, for 3D processing.
+    // If it is the frame that was decoded most recently, that frame's data is
+    // reused; otherwise it is prepared from the input (which is much cheaper
+    // than decoding it).
+    void loadPreviousFrame(const SourceField &firstField, const SourceField &secondField);
+
 protected:
 
 private:
@@ -82,6 +109,7 @@ private:
     bool configurationSet;
     Configuration configuration;
     LdDecodeMetaData::VideoParameters videoParameters;
+    OutputFrameLayout outputLayout;
 
     // IRE scaling
     qreal irescale;
@@ -89,16 +117,40 @@ private:
     // Calculated frame height
     qint32 frameHeight;
 
-    // Input frame buffer definitions
-    struct PixelLine {
-        qreal pixel[526][911]; // 526 is the maximum allowed field lines, 911 is the maximum field width
+    // Chroma samples for the active lines of a frame.  Lines are indexed by
+    // frame line number, and samples by their position in the line (up to
+    // activeVideoEnd).  Samples that are not written remain 0.
+    //
+    // The samples are floats, which hold values below 65536 to within 1/256
+    // of a 16-bit input step; testcomb checks the decoded result.
+    class ChromaBuffer {
+    public:
+        void resize(qint32 _firstLine, qint32 lastLine, qint32 _width) {
+            firstLine = _firstLine;
+            width = _width;
+            samples.fill(0.0f, (lastLine - firstLine) * width);
+        }
+
+        float *line(qint32 lineNumber) {
+            return samples.data() + ((lineNumber - firstLine) * width);
+        }
+        const float *line(qint32 lineNumber) const {
+            return samples.constData() + ((lineNumber - firstLine) * width);
+        }
+
+    private:
+        QVector<float> samples;
+        qint32 firstLine = 0;
+        qint32 width = 0;
     };
 
+    // Input frame buffer definitions
     struct FrameBuffer {
         QByteArray rawbuffer;
 
-        QVector<PixelLine> clpbuffer; // Unfiltered chroma for the current phase (can be I or Q)
-        QVector<qreal> kValues;
+        ChromaBuffer clpbuffer[3]; // Unfiltered chroma for the current phase (can be I or Q)
+        QVector<float> kValues; // Motion map for the active region (see getKIndex)
+        cv::Mat greyFrame; // Greyscale image for the optical flow analysis (if used)
         YiqBuffer yiqBuffer; // YIQ values for the frame
 
         qreal burstLevel; // The median colour burst amplitude for the frame
@@ -106,26 +158,86 @@ private:
         qint32 secondFieldPhaseID; // The phase of the frame's second field
     };
 
+    // The parts of a frame that 3D processing needs when decoding the
+    // following frame.  These depend only on the input fields, so they can be
+    // prepared for any frame without decoding it.
+    struct PreviousFrame {
+        qint32 frameNumber = -1; // The frame these were made from (-1 if unknown)
+        QByteArray rawbuffer;    // Interlaced input samples (empty if there's no frame)
+        cv::Mat greyFrame;       // Greyscale image for the optical flow analysis (if used)
+    };
+
     // Optical flow processor
     OpticalFlow opticalFlow;
 
-    // Previous and next frame for 3D processing
-    FrameBuffer previousFrameBuffer;
+    // Time spent in each stage of decoding, reported as debug output
+    struct StageTimes {
+        qint32 frames = 0;
+        qint64 motionNsecs = 0;
+        qint64 filterNsecs = 0;
+        qint64 outputNsecs = 0;
+    };
+    StageTimes stageTimes;
+
+    // Buffers for the frame being decoded.  These are allocated by
+    // updateConfiguration and reused for each frame
+    FrameBuffer currentFrameBuffer;
+    YiqBuffer tempYiqBuffer;
+
+    // Previous frame for 3D processing
+    PreviousFrame previousFrame;
+
+    // Size of the blocks used by detectMotionByDifference, in samples and
+    // frame lines
+    static constexpr qint32 MOTION_BLOCK_WIDTH = 16;
+    static constexpr qint32 MOTION_BLOCK_HEIGHT = 8;
+
+    // Working buffers for detectMotionByDifference.  These are allocated by
+    // updateConfiguration; the block counts and the horizontal interpolation
+    // tables depend only on the configuration, so they are filled in there
+    struct MotionBlocks {
+        qint32 blocksWide = 0;
+        qint32 blocksHigh = 0;
+        QVector<qint64> sums;       // Sum of the absolute luma differences in each block
+        QVector<qint32> counts;     // Number of samples in each block
+        QVector<float> k;           // K value of each block
+        QVector<float> spreadK;     // K value of each block after spreading into its neighbours
+        QVector<qint32> leftBlock;  // For each sample, the block columns to interpolate between
+        QVector<qint32> rightBlock;
+        QVector<float> xWeight;     // For each sample, the weight of rightBlock
+    };
+    MotionBlocks motionBlocks;
+
+    // Return the index of the K value for sample h of a line in a frame's
+    // kValues.  The K values cover only the active region
+    qint32 getKIndex(qint32 h, qint32 lineNumber) const {
+        return ((lineNumber - configuration.firstActiveLine) * (videoParameters.activeVideoEnd - videoParameters.activeVideoStart))
+               + (h - videoParameters.activeVideoStart);
+    }
+
+    void interlaceFields(const SourceField &firstField, const SourceField &secondField, QByteArray &rawbuffer);
+    void makeGreyFrame(const QByteArray &rawbuffer, cv::Mat &greyFrame);
 
     inline qint32 GetFieldID(FrameBuffer *frameBuffer, qint32 lineNumber);
     inline bool GetLinePhase(FrameBuffer *frameBuffer, qint32 lineNumber);
 
     void split1D(FrameBuffer *frameBuffer);
     void split2D(FrameBuffer *frameBuffer);
-    void split3D(FrameBuffer *currentFrame, FrameBuffer *previousFrame);
+    void split3D(FrameBuffer *currentFrame, const QByteArray &previousRawbuffer);
+
+    void detectMotion(FrameBuffer *frameBuffer);
+    void configureMotionBlocks();
+    void detectMotionByDifference(FrameBuffer *frameBuffer, const QByteArray &previousRawbuffer);
 
     void filterIQ(YiqBuffer &yiqBuffer);
     void splitIQ(FrameBuffer *frameBuffer);
 
+    void copyActiveLines(const YiqBuffer &source, YiqBuffer &destination);
+
     void doCNR(YiqBuffer &yiqBuffer);
     void doYNR(YiqBuffer &yiqBuffer);
 
-    QByteArray yiqToRgbFrame(const YiqBuffer &yiqBuffer, qreal burstLevel);
+    void yiqToRgbFrame(const YiqBuffer &yiqBuffer, qreal burstLevel, QByteArray &rgbOutputFrame);
     void overlayOpticalFlowMap(const FrameBuffer &frameBuffer, QByteArray &rgbOutputFrame);
     void adjustY(FrameBuffer *frameBuffer, YiqBuffer &yiqBuffer);
 };
@@ -37,9 +37,11 @@ qint32 Decoder::getLookAhead() const
 }
 
 void Decoder::setVideoParameters(Decoder::Configuration &config, const LdDecodeMetaData::VideoParameters &videoParameters,
+                                 OutputFrameLayout::PixelFormat pixelFormat,
                                  qint32 firstActiveLine, qint32 lastActiveLine) {
 
     config.videoParameters = videoParameters;
+    config.pixelFormat = pixelFormat;
     config.firstActiveLine = firstActiveLine;
     config.lastActiveLine = lastActiveLine;
     config.topPadLines = 0;
@@ -81,33 +83,21 @@ void Decoder::setVideoParameters(Decoder::Configuration &config, const LdDecodeM
     // Show output information to the user
     const qint32 frameHeight = (videoParameters.fieldHeight * 2) - 1;
     qInfo() << "Input video of" << config.videoParameters.fieldWidth << "x" << frameHeight <<
-               "will be colourised and trimmed to" << outputWidth << "x" << outputHeight << "RGB 16-16-16 frames";
+               "will be colourised and trimmed to" << outputWidth << "x" << outputHeight <<
+               OutputFrameLayout::getPixelFormatName(pixelFormat) << "frames";
 }
 
-QByteArray Decoder::cropOutputFrame(const Decoder::Configuration &config, QByteArray outputData) {
-    const qint32 activeVideoStart = config.videoParameters.activeVideoStart;
-    const qint32 activeVideoEnd = config.videoParameters.activeVideoEnd;
-    const qint32 outputLineBytes = (activeVideoEnd - activeVideoStart) * 6;
-
-    QByteArray croppedData;
-
-    // Insert padding at the top
-    if (config.topPadLines > 0) {
-        croppedData.append(config.topPadLines * outputLineBytes, 0);
-    }
-
-    // Copy the active region from the decoded image
-    for (qint32 y = config.firstActiveLine; y < config.lastActiveLine; y++) {
-        croppedData.append(outputData.mid((y * config.videoParameters.fieldWidth * 6) + (activeVideoStart * 6),
-                                          outputLineBytes));
-    }
-
-    // Insert padding at the bottom
-    if (config.bottomPadLines > 0) {
-        croppedData.append(config.bottomPadLines * outputLineBytes, 0);
-    }
-
-    return croppedData;
+OutputFrameLayout Decoder::computeOutputLayout(const Decoder::Configuration &config) {
+    // The padding lines are outside the active area, so the decoders leave
+    // them black
+    OutputFrameLayout layout;
+    layout.pixelFormat = config.pixelFormat;
+    layout.left = config.videoParameters.activeVideoStart;
+    layout.top = config.firstActiveLine - config.topPadLines;
+    layout.width = config.videoParameters.activeVideoEnd - config.videoParameters.activeVideoStart;
+    layout.height = config.topPadLines + (config.lastActiveLine - config.firstActiveLine) + config.bottomPadLines;
+
+    return layout;
 }
 
 DecoderThread::DecoderThread(QAtomicInt& _abort, DecoderPool& _decoderPool, QObject *parent)
@@ -135,7 +125,8 @@ void DecoderThread::run()
         // Decode the fields to frames
         decodeFrames(inputFields, startIndex, endIndex, outputFrames);
 
-        // Write the frames to the output file
+        // Write the frames to the output file (this replaces them with
+        // recycled buffers for the next batch)
         if (!decoderPool.putOutputFrames(startFrameNumber, outputFrames)) {
             abort = true;
             break;
@@ -33,6 +33,7 @@
 
 #include "lddecodemetadata.h"
 
+#include "outputframelayout.h"
 #include "sourcefield.h"
 
 class DecoderPool;
@@ -59,9 +60,10 @@ class Decoder {
 public:
     virtual ~Decoder() = default;
 
-    // Configure the decoder given input video parameters.
+    // Configure the decoder given input video parameters and the output pixel format.
     // If the video is not compatible, print an error message and return false.
-    virtual bool configure(const LdDecodeMetaData::VideoParameters &videoParameters) = 0;
+    virtual bool configure(const LdDecodeMetaData::VideoParameters &videoParameters,
+                           OutputFrameLayout::PixelFormat pixelFormat) = 0;
 
     // After configuration, return the number of frames that the decoder needs
     // to be able to see into the past (each frame being two SourceFields).
@@ -73,6 +75,9 @@ public:
     // The default implementation returns 0, which is appropriate for 1D/2D decoders.
     virtual qint32 getLookAhead() const;
 
+    // After configuration, return the layout of the output frames
+    virtual OutputFrameLayout getOutputLayout() const = 0;
+
     // Construct a new worker thread
     virtual QThread *makeThread(QAtomicInt& abort, DecoderPool& decoderPool) = 0;
 
@@ -85,15 +90,17 @@ public:
         qint32 lastActiveLine;
         qint32 topPadLines;
         qint32 bottomPadLines;
+        OutputFrameLayout::PixelFormat pixelFormat;
     };
 
     // Compute the output frame size in Configuration, adjusting the active
     // video region as required
     static void setVideoParameters(Configuration &config, const LdDecodeMetaData::VideoParameters &videoParameters,
+                                   OutputFrameLayout::PixelFormat pixelFormat,
                                    qint32 firstActiveLine, qint32 lastActiveLine);
 
-    // Crop a full decoded frame to the output frame size
-    static QByteArray cropOutputFrame(const Configuration &config, QByteArray outputData);
+    // Compute the layout of output frames: the active area, plus padding
+    static OutputFrameLayout computeOutputLayout(const Configuration &config);
 };
 
 // Abstract base class for chroma decoder worker threads.
@@ -105,7 +112,9 @@ public:
 protected:
     void run() override;
 
-    // Decode a sequence of fields into a sequence of frames
+    // Decode a sequence of fields into a sequence of frames, laid out as
+    // given by Decoder::computeOutputLayout. outputFrames may contain buffers
+    // recycled from earlier frames, which should be reused.
     virtual void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                               QVector<QByteArray> &outputFrames) = 0;
 
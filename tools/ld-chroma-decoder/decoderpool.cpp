@@ -27,23 +27,49 @@
 // Definitions of static constexpr data members, for compatibility with
 // pre-C++17 compilers
 constexpr qint32 DecoderPool::DEFAULT_BATCH_SIZE;
+constexpr qint32 DecoderPool::MAX_BATCH_SIZE;
+constexpr qint32 DecoderPool::BATCHES_PER_THREAD;
+constexpr qint32 DecoderPool::REORDER_BUFFER_BATCHES;
+
+// Maximum time to wait for the output before checking the abort flag, in ms
+// (worker threads set the flag without waking threads waiting for the output)
+static constexpr unsigned long ABORT_CHECK_INTERVAL = 100;
+
+// Thread that writes the output frames, so the worker threads never wait for
+// the output file
+class OutputWriterThread : public QThread
+{
+public:
+    OutputWriterThread(DecoderPool &_decoderPool) : decoderPool(_decoderPool) {}
+
+protected:
+    void run() override {
+        decoderPool.writeOutputFrames();
+    }
+
+private:
+    DecoderPool &decoderPool;
+};
 
 DecoderPool::DecoderPool(Decoder &_decoder, QString _inputFileName,
                          LdDecodeMetaData &_ldDecodeMetaData, QString _outputFileName,
-                         qint32 _startFrame, qint32 _length, qint32 _maxThreads)
+                         qint32 _startFrame, qint32 _length, qint32 _maxThreads,
+                         OutputFrameLayout::PixelFormat _pixelFormat, bool _outputY4m,
+                         qint32 _prefetchDepth)
     : decoder(_decoder), inputFileName(_inputFileName),
       outputFileName(_outputFileName), startFrame(_startFrame),
-      length(_length), maxThreads(_maxThreads),
+      length(_length), maxThreads(_maxThreads), pixelFormat(_pixelFormat),
+      outputY4m(_outputY4m), prefetchDepth(_prefetchDepth),
       abort(false), ldDecodeMetaData(_ldDecodeMetaData)
 {
 }
 
 bool DecoderPool::process()
 {
-    LdDecodeMetaData::VideoParameters videoParameters = ldDecodeMetaData.getVideoParameters();
+    videoParameters = ldDecodeMetaData.getVideoParameters();
 
     // Configure the decoder, and check that it can accept this video
-    if (!decoder.configure(videoParameters)) {
+    if (!decoder.configure(videoParameters, pixelFormat)) {
         return false;
     }
 
@@ -51,12 +77,25 @@ bool DecoderPool::process()
     decoderLookBehind = decoder.getLookBehind();
     decoderLookAhead = decoder.getLookAhead();
 
+    // Each batch also has to decode its lookbehind/lookahead frames, so for
+    // decoders that need a lot of them, allow larger batches to keep that
+    // overhead below about 25%
+    maxBatchSize = qBound(DEFAULT_BATCH_SIZE, 4 * (decoderLookBehind + decoderLookAhead), MAX_BATCH_SIZE);
+
+    // If the input is a pipe, keep enough fields for a batch and its
+    // lookbehind/lookahead (plus some spare for out-of-order fields)
+    sourceVideo.setStreamWindow((2 * (decoderLookBehind + maxBatchSize + decoderLookAhead)) + 4);
+
     // Open the source video file
     if (!sourceVideo.open(inputFileName, videoParameters.fieldWidth * videoParameters.fieldHeight)) {
         // Could not open source video file
         qInfo() << "Unable to open ld-decode video file";
         return false;
     }
+    if (sourceVideo.isStreaming()) qInfo() << "Using streamed TBC input";
+
+    // Set the read-ahead depth (if not specified, use the default)
+    if (prefetchDepth != -1) sourceVideo.setPrefetchDepth(prefetchDepth);
 
     // If no startFrame parameter was specified, set the start frame to 1
     if (startFrame == -1) startFrame = 1;
@@ -76,27 +115,34 @@ bool DecoderPool::process()
         }
     }
 
-    // Open the output RGB file
+    // Open the output file
     if (outputFileName.isNull()) {
         // No output filename, use stdout instead
         if (!targetVideo.open(stdout, QIODevice::WriteOnly)) {
             // Failed to open stdout
-            qCritical() << "Could not open stdout for RGB output";
+            qCritical() << "Could not open stdout for output";
             sourceVideo.close();
             return false;
         }
-        qInfo() << "Using stdout as RGB output";
+        qInfo() << "Using stdout as output";
     } else {
         // Open output file
         targetVideo.setFileName(outputFileName);
         if (!targetVideo.open(QIODevice::WriteOnly)) {
             // Failed to open output file
-            qCritical() << "Could not open " << outputFileName << "as RGB output file";
+            qCritical() << "Could not open " << outputFileName << "as output file";
             sourceVideo.close();
             return false;
         }
     }
 
+    // Write the stream header, if the output is Y4M
+    if (outputY4m && !writeY4mHeader()) {
+        sourceVideo.close();
+        targetVideo.close();
+        return false;
+    }
+
     qInfo() << "Using" << maxThreads << "threads";
     qInfo() << "Processing from start frame #" << startFrame << "with a length of" << length << "frames";
 
@@ -104,8 +150,18 @@ bool DecoderPool::process()
     inputFrameNumber = startFrame;
     outputFrameNumber = startFrame;
     lastFrameNumber = length + (startFrame - 1);
+    const qint32 reorderBufferSize = (REORDER_BUFFER_BATCHES * maxBatchSize) + maxThreads;
+    reorderBuffer.fill(QByteArray(), reorderBufferSize);
+    isReorderSlotFull.fill(false, reorderBufferSize);
+    pendingOutputFrames = 0;
+    freeOutputFrames.clear();
+    freeOutputFrames.reserve(reorderBufferSize);
     totalTimer.start();
 
+    // Start the output writer thread
+    OutputWriterThread writerThread(*this);
+    writerThread.start();
+
     // Start a vector of filtering threads to process the video
     QVector<QThread *> threads;
     threads.resize(maxThreads);
@@ -120,6 +176,16 @@ bool DecoderPool::process()
         delete threads[i];
     }
 
+    // Wait for the writer to finish (waking it up if the workers aborted
+    // without giving it all the frames)
+    outputMutex.lock();
+    outputFrameAvailable.wakeAll();
+    outputMutex.unlock();
+    writerThread.wait();
+
+    // Release the recycled output buffers
+    freeOutputFrames.clear();
+
     // Did any of the threads abort?
     if (abort) {
         sourceVideo.close();
@@ -129,7 +195,7 @@ bool DecoderPool::process()
 
     // Check we've processed all the frames, now the workers have finished
     if (inputFrameNumber != (lastFrameNumber + 1) || outputFrameNumber != (lastFrameNumber + 1)
-        || !pendingOutputFrames.empty()) {
+        || pendingOutputFrames != 0) {
         qCritical() << "Incorrect state at end of processing";
         sourceVideo.close();
         targetVideo.close();
@@ -140,6 +206,20 @@ bool DecoderPool::process()
     qInfo() << "Processing complete -" << length << "frames in" << totalSecs << "seconds (" <<
                length / totalSecs << "FPS )";
 
+    // Show the read-ahead statistics (for tuning --prefetch)
+    if (sourceVideo.getPrefetchDepth() > 0) {
+        SourceVideo::PrefetchStatistics prefetchStatistics = sourceVideo.getPrefetchStatistics();
+        qInfo() << "Input read-ahead -" << prefetchStatistics.hits << "hits," << prefetchStatistics.misses << "misses," <<
+                   static_cast<qreal>(prefetchStatistics.stallTime) / 1000000000.0 << "seconds waiting for input";
+    }
+
+    // Show the field cache statistics (for tuning --cache)
+    FieldCache::Statistics cacheStatistics = sourceVideo.getCacheStatistics();
+    if (cacheStatistics.hits + cacheStatistics.misses > 0) {
+        qInfo() << "Input field cache -" << cacheStatistics.hits << "hits," << cacheStatistics.misses << "misses," <<
+                   cacheStatistics.evictions << "evictions";
+    }
+
     // Close the source video
     sourceVideo.close();
 
@@ -153,70 +233,113 @@ bool DecoderPool::getInputFrames(qint32 &startFrameNumber, QVector<SourceField>
 {
     QMutexLocker locker(&inputMutex);
 
-    // Work out a reasonable batch size to provide work for all threads.
-    // This assumes that the synchronisation to get a new batch is less
-    // expensive than computing a single frame, so a batch size of 1 is
-    // reasonable.
-    const qint32 maxBatchSize = qMin(DEFAULT_BATCH_SIZE, qMax(1, length / maxThreads));
-
-    // Work out how many frames will be in this batch
-    qint32 batchFrames = qMin(maxBatchSize, lastFrameNumber + 1 - inputFrameNumber);
-    if (batchFrames == 0) {
+    const qint32 remainingFrames = lastFrameNumber + 1 - inputFrameNumber;
+    if (remainingFrames == 0) {
         // No more input frames
         return false;
     }
 
+    // Work out how many frames will be in this batch.  Each batch takes a
+    // fraction of the remaining frames (guided self-scheduling), so batches
+    // are large while there's plenty of work, and shrink towards the end of
+    // the input so that all the threads finish at about the same time rather
+    // than waiting for one thread's large final batch.  This assumes that the
+    // synchronisation to get a new batch is less expensive than computing a
+    // single frame, so a batch size of 1 is reasonable.
+    const qint32 batchFrames = qBound(1, remainingFrames / (BATCHES_PER_THREAD * maxThreads), maxBatchSize);
+
     // Advance the frame number
     startFrameNumber = inputFrameNumber;
     inputFrameNumber += batchFrames;
 
-    // Load the fields
-    SourceField::loadFields(sourceVideo, ldDecodeMetaData,
-                            startFrameNumber, batchFrames, decoderLookBehind, decoderLookAhead,
-                            fields, startIndex, endIndex);
+    // Load the metadata for the fields
+    QVector<qint32> fieldNumbers;
+    SourceField::loadFieldsMetadata(ldDecodeMetaData,
+                                    startFrameNumber, batchFrames, decoderLookBehind, decoderLookAhead,
+                                    fields, fieldNumbers, startIndex, endIndex);
+    const quint16 black = static_cast<quint16>(videoParameters.black16bIre);
+
+    // Load the video data.  SourceVideo is safe to call from multiple threads,
+    // so this doesn't need to hold inputMutex -- unless the input is streamed,
+    // in which case batches must be read in order
+    if (!sourceVideo.isStreaming()) locker.unlock();
+    SourceField::loadFieldsData(sourceVideo, fieldNumbers, black, fields);
 
     return true;
 }
 
-bool DecoderPool::putOutputFrames(qint32 startFrameNumber, const QVector<QByteArray> &outputFrames)
+bool DecoderPool::putOutputFrames(qint32 startFrameNumber, QVector<QByteArray> &outputFrames)
 {
     QMutexLocker locker(&outputMutex);
 
     for (qint32 i = 0; i < outputFrames.size(); i++) {
-        if (!putOutputFrame(startFrameNumber + i, outputFrames[i])) {
-            return false;
+        const qint32 frameNumber = startFrameNumber + i;
+
+        // Wait until the frame's slot in the reorder buffer is free.  This
+        // limits how far the workers can get ahead of the output
+        while (frameNumber >= outputFrameNumber + reorderBuffer.size() && !abort) {
+            reorderSpaceAvailable.wait(&outputMutex, ABORT_CHECK_INTERVAL);
         }
+        if (abort) return false;
+
+        // Move the frame into its (empty) slot, and give the worker a
+        // recycled buffer in its place
+        const qint32 slot = frameNumber % reorderBuffer.size();
+        reorderBuffer[slot].swap(outputFrames[i]);
+        if (!freeOutputFrames.isEmpty()) {
+            outputFrames[i].swap(freeOutputFrames.last());
+            freeOutputFrames.removeLast();
+        }
+        isReorderSlotFull[slot] = true;
+        pendingOutputFrames++;
+
+        if (frameNumber == outputFrameNumber) outputFrameAvailable.wakeOne();
     }
 
     return true;
 }
 
-// Write one output frame. You must hold outputMutex to call this.
-//
 // The worker threads will complete frames in an arbitrary order, so we can't
-// just write the frames to the output file directly. Instead, we keep a map of
-// frames that haven't yet been written; when a new frame comes in, we check
-// whether we can now write some of them out.
-//
-// Returns true on success, false on failure.
-bool DecoderPool::putOutputFrame(qint32 frameNumber, const QByteArray &outputFrame)
+// just write the frames to the output file directly. Instead, frames wait in
+// the reorder buffer, and this writes them out as soon as the next frame in
+// sequence is available.
+void DecoderPool::writeOutputFrames()
 {
-    // Put this frame into the map
-    pendingOutputFrames[frameNumber] = outputFrame;
+    QMutexLocker locker(&outputMutex);
 
-    // Write out as many frames as possible
-    while (pendingOutputFrames.contains(outputFrameNumber)) {
-        const QByteArray& outputData = pendingOutputFrames.value(outputFrameNumber);
+    while (outputFrameNumber <= lastFrameNumber) {
+        // Wait for the next frame
+        const qint32 slot = outputFrameNumber % reorderBuffer.size();
+        while (!isReorderSlotFull[slot] && !abort) {
+            outputFrameAvailable.wait(&outputMutex, ABORT_CHECK_INTERVAL);
+        }
+        if (abort) break;
 
-        // Save the frame data to the output file
-        if (!targetVideo.write(outputData.data(), outputData.size())) {
+        // Take the frame out of the reorder buffer, freeing its slot
+        QByteArray outputData;
+        outputData.swap(reorderBuffer[slot]);
+        isReorderSlotFull[slot] = false;
+        pendingOutputFrames--;
+        outputFrameNumber++;
+        reorderSpaceAvailable.wakeAll();
+
+        // Save the frame data to the output file (preceded by a frame header
+        // for Y4M), without holding outputMutex
+        locker.unlock();
+        if ((outputY4m && targetVideo.write("FRAME\n") != 6)
+            || targetVideo.write(outputData.constData(), outputData.size()) != outputData.size()) {
             // Could not write to target video file
             qCritical() << "Writing to the output video file failed";
-            return false;
+            locker.relock();
+            abort = true;
+            reorderSpaceAvailable.wakeAll();
+            break;
         }
+        locker.relock();
 
-        pendingOutputFrames.remove(outputFrameNumber);
-        outputFrameNumber++;
+        // Recycle the buffer for another frame
+        freeOutputFrames.append(QByteArray());
+        freeOutputFrames.last().swap(outputData);
 
         const qint32 outputCount = outputFrameNumber - startFrame;
         if ((outputCount % 32) == 0) {
@@ -225,6 +348,41 @@ bool DecoderPool::putOutputFrame(qint32 frameNumber, const QByteArray &outputFra
             qInfo() << outputCount << "frames processed -" << fps << "FPS";
         }
     }
+}
+
+// Write the YUV4MPEG2 stream header to the output file.
+// Returns true on success, false on failure.
+bool DecoderPool::writeY4mHeader()
+{
+    const OutputFrameLayout outputLayout = decoder.getOutputLayout();
+
+    // Work out the Y4M colourspace name
+    QString colourSpace;
+    switch (outputLayout.pixelFormat) {
+    case OutputFrameLayout::YUV444P16:
+        colourSpace = "444p16";
+        break;
+    case OutputFrameLayout::YUV422P10:
+        colourSpace = "422p10";
+        break;
+    case OutputFrameLayout::GRAY16:
+        colourSpace = "mono16";
+        break;
+    default:
+        qCritical() << "Y4M output is not possible with the"
+                    << OutputFrameLayout::getPixelFormatName(outputLayout.pixelFormat) << "format";
+        return false;
+    }
+
+    // The frames are interlaced, with the first field on the top line
+    const QString frameRate = videoParameters.isSourcePal ? "25:1" : "30000:1001";
+    const QByteArray header = QString("YUV4MPEG2 W%1 H%2 F%3 It A0:0 C%4\n")
+                              .arg(outputLayout.width).arg(outputLayout.height).arg(frameRate).arg(colourSpace).toLatin1();
+
+    if (targetVideo.write(header) != header.size()) {
+        qCritical() << "Writing to the output video file failed";
+        return false;
+    }
 
     return true;
 }
@@ -29,10 +29,10 @@
 #include <QAtomicInt>
 #include <QByteArray>
 #include <QElapsedTimer>
-#include <QMap>
 #include <QMutex>
 #include <QThread>
 #include <QVector>
+#include <QWaitCondition>
 
 #include "lddecodemetadata.h"
 #include "sourcevideo.h"
@@ -43,9 +43,14 @@
 class DecoderPool
 {
 public:
+    // pixelFormat gives the format of the output frames.  If outputY4m is
+    // true, the output is written as a YUV4MPEG2 stream (which requires a
+    // YUV or greyscale format).
     explicit DecoderPool(Decoder &decoder, QString inputFileName,
                          LdDecodeMetaData &ldDecodeMetaData, QString outputFileName,
-                         qint32 startFrame, qint32 length, qint32 maxThreads);
+                         qint32 startFrame, qint32 length, qint32 maxThreads,
+                         OutputFrameLayout::PixelFormat pixelFormat = OutputFrameLayout::RGB48,
+                         bool outputY4m = false, qint32 prefetchDepth = -1);
 
     // Decode fields to frames as specified by the constructor args.
     // Returns true on success; on failure, prints a message and returns false.
@@ -63,23 +68,49 @@ public:
     // endIndex. Dummy black frames (with metadata copied from a real frame)
     // will be provided when going beyond the bounds of the input file.
     //
+    // If the input is streamed, batches are read in order, so the input
+    // window only needs to cover one batch and its lookbehind/lookahead.
+    //
     // Returns true if a frame was returned, false if the end of the input has
     // been reached.
     bool getInputFrames(qint32 &startFrameNumber, QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex);
 
     // For worker threads: return decoded frames to write to the output file.
     //
-    // outputFrames should contain RGB16-16-16 output frames, with the first
-    // frame being startFrameNumber.
+    // outputFrames should contain output frames in the decoder's output
+    // layout, with the first frame being startFrameNumber.
+    //
+    // If the output is too far behind, this blocks until there is space for
+    // the frames.
+    //
+    // The frames are moved out of outputFrames, not copied. In their place,
+    // outputFrames gets buffers from frames that have already been written,
+    // if there are any, so the worker can reuse them for its next batch.
     //
     // Returns true on success, false on failure.
-    bool putOutputFrames(qint32 startFrameNumber, const QVector<QByteArray> &outputFrames);
+    bool putOutputFrames(qint32 startFrameNumber, QVector<QByteArray> &outputFrames);
+
+    // For the output writer thread: write the output frames in order as they
+    // become available, until all frames have been written or processing is
+    // aborted.
+    void writeOutputFrames();
 
 private:
-    bool putOutputFrame(qint32 frameNumber, const QByteArray &outputFrame);
+    bool writeY4mHeader();
 
-    // Default batch size, in frames
+    // Batch sizes, in frames.  Batches are normally at most DEFAULT_BATCH_SIZE,
+    // but may be up to MAX_BATCH_SIZE for decoders with a lot of lookbehind or
+    // lookahead (see process())
     static constexpr qint32 DEFAULT_BATCH_SIZE = 16;
+    static constexpr qint32 MAX_BATCH_SIZE = 64;
+
+    // Divides the remaining frames into batches (see getInputFrames())
+    static constexpr qint32 BATCHES_PER_THREAD = 2;
+
+    // Size of the output reorder buffer, in maximum-sized batches (plus one
+    // frame per thread).  This must be at least one batch, so the thread
+    // with the oldest batch can always output it
+    static constexpr qint32 REORDER_BUFFER_BATCHES = 2;
 
     // Parameters
     Decoder& decoder;
@@ -88,6 +119,9 @@ private:
     qint32 startFrame;
     qint32 length;
     qint32 maxThreads;
+    OutputFrameLayout::PixelFormat pixelFormat;
+    bool outputY4m;
+    qint32 prefetchDepth;
 
     // Atomic abort flag shared by worker threads; workers watch this, and shut
     // down as soon as possible if it becomes true
@@ -97,17 +131,34 @@ private:
     QMutex inputMutex;
     qint32 decoderLookBehind;
     qint32 decoderLookAhead;
+    qint32 maxBatchSize;
     qint32 inputFrameNumber;
     qint32 lastFrameNumber;
     LdDecodeMetaData &ldDecodeMetaData;
+    LdDecodeMetaData::VideoParameters videoParameters;
+
+    // Input video (safe to read from multiple threads without inputMutex,
+    // unless the input is streamed)
     SourceVideo sourceVideo;
 
-    // Output stream information (all guarded by outputMutex while threads are running)
+    // Output stream information (all guarded by outputMutex while threads are running).
+    // Frames wait in the reorder buffer until they can be written in order;
+    // frame N is stored in slot N % reorderBuffer.size()
     QMutex outputMutex;
+    QWaitCondition outputFrameAvailable;
+    QWaitCondition reorderSpaceAvailable;
     qint32 outputFrameNumber;
-    QMap<qint32, QByteArray> pendingOutputFrames;
-    QFile targetVideo;
+    QVector<QByteArray> reorderBuffer;
+    QVector<bool> isReorderSlotFull;
+    qint32 pendingOutputFrames;
+
+    // Buffers from frames that have been written, ready to be reused
+    // (guarded by outputMutex)
+    QVector<QByteArray> freeOutputFrames;
     QElapsedTimer totalTimer;
+
+    // Output file (only used by the writer thread while threads are running)
+    QFile targetVideo;
 };
 
 #endif // DECODERPOOL_H
@@ -24,10 +24,10 @@
 
 #include "framecanvas.h"
 
-FrameCanvas::FrameCanvas(QByteArray &_rgbFrame, const LdDecodeMetaData::VideoParameters &_videoParameters,
+FrameCanvas::FrameCanvas(QByteArray &_rgbFrame, const OutputFrameLayout &_layout,
+                         const LdDecodeMetaData::VideoParameters &_videoParameters,
                          qint32 _firstActiveLine, qint32 _lastActiveLine)
-    : rgbData(reinterpret_cast<quint16 *>(_rgbFrame.data())), rgbSize(_rgbFrame.size() / sizeof(quint16)),
-      videoParameters(_videoParameters), firstActiveLine(_firstActiveLine), lastActiveLine(_lastActiveLine)
+    : rgbFrame(_rgbFrame), layout(_layout), videoParameters(_videoParameters), firstActiveLine(_firstActiveLine), lastActiveLine(_lastActiveLine)
 {
 }
 
@@ -60,15 +60,15 @@ FrameCanvas::RGB FrameCanvas::grey(quint16 value)
 
 void FrameCanvas::drawPoint(qint32 x, qint32 y, const RGB& colour)
 {
-    const qint32 offset = ((y * videoParameters.fieldWidth) + x) * 3;
-    if (x < 0 || x >= videoParameters.fieldWidth || offset < 0 || offset >= (rgbSize - 2)) {
+    if (!layout.contains(x, y)) {
         // Outside the frame
         return;
     }
 
-    rgbData[offset] = colour.r;
-    rgbData[offset + 1] = colour.g;
-    rgbData[offset + 2] = colour.b;
+    quint16 *pixel = layout.getPixel(rgbFrame, x, y);
+    pixel[0] = colour.r;
+    pixel[1] = colour.g;
+    pixel[2] = colour.b;
 }
 
 void FrameCanvas::drawRectangle(qint32 xStart, qint32 yStart, qint32 w, qint32 h, const RGB& colour)
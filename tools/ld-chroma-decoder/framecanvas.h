@@ -30,12 +30,15 @@
 
 #include "lddecodemetadata.h"
 
-// Context for drawing on top of a full-frame RGB image.
+#include "outputframelayout.h"
+
+// Context for drawing on top of an RGB output frame, using full-frame coordinates.
 class FrameCanvas {
 public:
-    // rgbFrame is the frame to draw upon, and videoParameters gives its dimensions.
-    // (Both parameters are captured by reference, not copied.)
-    FrameCanvas(QByteArray &rgbFrame, const LdDecodeMetaData::VideoParameters &videoParameters,
+    // rgbFrame is the frame to draw upon, and layout gives its position within the full frame.
+    // (rgbFrame and videoParameters are captured by reference, not copied.)
+    FrameCanvas(QByteArray &rgbFrame, const OutputFrameLayout &layout,
+                const LdDecodeMetaData::VideoParameters &videoParameters,
                 qint32 firstActiveLine, qint32 lastActiveLine);
 
     // Return the edges of the active area.
@@ -61,8 +64,8 @@ public:
     void fillRectangle(qint32 x, qint32 y, qint32 w, qint32 h, const RGB& colour);
 
 private:
-    quint16 *rgbData;
-    qint32 rgbSize;
+    QByteArray &rgbFrame;
+    OutputFrameLayout layout;
     const LdDecodeMetaData::VideoParameters &videoParameters;
     qint32 firstActiveLine;
     qint32 lastActiveLine;
@@ -15,7 +15,6 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
-    comb.cpp \
     decoder.cpp \
     decoderpool.cpp \
     framecanvas.cpp \
@@ -23,6 +22,7 @@ SOURCES += \
     monodecoder.cpp \
     ntscdecoder.cpp \
     opticalflow.cpp \
+    outputframelayout.cpp \
     palcolour.cpp \
     paldecoder.cpp \
     rgb.cpp \
@@ -31,7 +31,11 @@ SOURCES += \
     transformpal2d.cpp \
     transformpal3d.cpp \
     yiq.cpp \
+    ../library/tbc/jsonreader.cpp \
+    ../library/tbc/jsonwriter.cpp \
     ../library/tbc/lddecodemetadata.cpp \
+    ../library/tbc/fieldcache.cpp \
+    ../library/tbc/fieldcompressor.cpp \
     ../library/tbc/sourcevideo.cpp
 
 HEADERS += \
@@ -43,7 +47,9 @@ HEADERS += \
     monodecoder.h \
     ntscdecoder.h \
     opticalflow.h \
+    outputframelayout.h \
     palcolour.h \
+    palcolourfilter.h \
     paldecoder.h \
     rgb.h \
     sourcefield.h \
@@ -53,12 +59,20 @@ HEADERS += \
     yiq.h \
     yiqbuffer.h \
     ../../deemp.h \
+    ../library/tbc/jsonreader.h \
+    ../library/tbc/jsonwriter.h \
     ../library/tbc/lddecodemetadata.h \
+    ../library/tbc/fieldcache.h \
+    ../library/tbc/fieldcompressor.h \
     ../library/tbc/sourcevideo.h
 
 # Add external includes to the include path
 INCLUDEPATH += ../library/tbc
 
+# Comb's kernels are built with auto-vectorisation (see vectorise.pri)
+VECTORISED_SOURCES = comb.cpp
+include(vectorise.pri)
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /usr/local/bin/
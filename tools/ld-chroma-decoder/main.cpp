@@ -32,6 +32,7 @@
 
 #include "decoderpool.h"
 #include "lddecodemetadata.h"
+#include "sourcevideo.h"
 
 #include "comb.h"
 #include "monodecoder.h"
@@ -157,6 +158,32 @@ int main(int argc, char *argv[])
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to select the input read-ahead depth
+    QCommandLineOption prefetchOption(QStringList() << "prefetch",
+                                      QCoreApplication::translate("main", "Specify the input read-ahead depth in fields (0 to disable; default 64)"),
+                                      QCoreApplication::translate("main", "number"));
+    parser.addOption(prefetchOption);
+
+    // Option to specify the input JSON metadata file (needed for piped input)
+    QCommandLineOption inputJsonOption(QStringList() << "input-json",
+                                       QCoreApplication::translate("main", "Specify the input JSON file (default input.json)"),
+                                       QCoreApplication::translate("main", "filename"));
+    parser.addOption(inputJsonOption);
+
+    // Option to select the field cache size (--cache)
+    SourceVideo::addCacheSizeOption(parser);
+
+    // Option to select the output pixel format (-p)
+    QCommandLineOption outputFormatOption(QStringList() << "p" << "output-format",
+                                          QCoreApplication::translate("main", "Output format (rgb48, yuv444p16, yuv422p10, gray16; default rgb48)"),
+                                          QCoreApplication::translate("main", "format"));
+    parser.addOption(outputFormatOption);
+
+    // Option to write the output as a YUV4MPEG2 stream
+    QCommandLineOption outputY4mOption(QStringList() << "output-y4m",
+                                       QCoreApplication::translate("main", "Write the output as YUV4MPEG2 (for the YUV and gray formats)"));
+    parser.addOption(outputY4mOption);
+
     // -- NTSC decoder options --
 
     // Option to show the optical flow map (-o)
@@ -169,6 +196,12 @@ int main(int argc, char *argv[])
                                         QCoreApplication::translate("main", "NTSC: Use 75% white-point (default 100%)"));
     parser.addOption(whitePointOption);
 
+    // Option to select the 3D motion detection mode
+    QCommandLineOption motionModeOption(QStringList() << "motion-mode",
+                                        QCoreApplication::translate("main", "NTSC: Motion detection for ntsc3d (flow, difference; default flow)"),
+                                        QCoreApplication::translate("main", "mode"));
+    parser.addOption(motionModeOption);
+
     // -- PAL decoder options --
 
     // Option to select the Transform PAL filter mode
@@ -191,14 +224,17 @@ int main(int argc, char *argv[])
     // -- Positional arguments --
 
     // Positional argument to specify input video file
-    parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file"));
+    parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file (- for piped input)"));
 
     // Positional argument to specify output video file
-    parser.addPositionalArgument("output", QCoreApplication::translate("main", "Specify output RGB file (omit for piped output)"));
+    parser.addPositionalArgument("output", QCoreApplication::translate("main", "Specify output file (omit for piped output)"));
 
     // Process the command line options and arguments given by the user
     parser.process(a);
 
+    // Set the input field cache size (if specified)
+    if (!SourceVideo::applyCacheSizeOption(parser)) return -1;
+
     // Get the options from the parser
     bool isDebugOn = parser.isSet(showDebugOption);
     if (parser.isSet(setQuietOption)) showOutput = false;
@@ -217,7 +253,7 @@ int main(int argc, char *argv[])
             outputFileName.clear(); // Use pipe
         } else {
             // Quit with error
-            qCritical("You must specify the input TBC and output RGB files");
+            qCritical("You must specify the input TBC and output files");
             return -1;
         }
     }
@@ -228,9 +264,21 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // Work out the input JSON filename
+    QString inputJsonFileName = inputFileName + ".json";
+    if (parser.isSet(inputJsonOption)) {
+        inputJsonFileName = parser.value(inputJsonOption);
+    } else if (inputFileName == "-") {
+        // Quit with error
+        qCritical("You must specify the input JSON file when using piped input");
+        return -1;
+    }
+
     qint32 startFrame = -1;
     qint32 length = -1;
     qint32 maxThreads = QThread::idealThreadCount();
+    qint32 prefetchDepth = -1;
+    OutputFrameLayout::PixelFormat pixelFormat = OutputFrameLayout::RGB48;
     PalColour::Configuration palConfig;
     Comb::Configuration combConfig;
 
@@ -264,6 +312,33 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (parser.isSet(prefetchOption)) {
+        prefetchDepth = parser.value(prefetchOption).toInt();
+
+        if (prefetchDepth < 0) {
+            // Quit with error
+            qCritical("Specified read-ahead depth must not be negative");
+            return -1;
+        }
+    }
+
+    if (parser.isSet(outputFormatOption)) {
+        const QString name = parser.value(outputFormatOption);
+
+        if (!OutputFrameLayout::getPixelFormat(name, pixelFormat)) {
+            // Quit with error
+            qCritical() << "Unknown output format " << name;
+            return -1;
+        }
+    }
+
+    const bool outputY4m = parser.isSet(outputY4mOption);
+    if (outputY4m && pixelFormat == OutputFrameLayout::RGB48) {
+        // Quit with error
+        qCritical("Y4M output requires a YUV or gray output format");
+        return -1;
+    }
+
     if (parser.isSet(setBwModeOption)) {
         palConfig.blackAndWhite = true;
         combConfig.blackAndWhite = true;
@@ -277,6 +352,20 @@ int main(int argc, char *argv[])
         combConfig.showOpticalFlowMap = true;
     }
 
+    if (parser.isSet(motionModeOption)) {
+        const QString name = parser.value(motionModeOption);
+
+        if (name == "flow") {
+            combConfig.motionMode = Comb::opticalFlowMode;
+        } else if (name == "difference") {
+            combConfig.motionMode = Comb::frameDifferenceMode;
+        } else {
+            // Quit with error
+            qCritical() << "Unknown motion detection mode " << name;
+            return -1;
+        }
+    }
+
     if (parser.isSet(transformModeOption)) {
         const QString name = parser.value(transformModeOption);
 
@@ -309,9 +398,11 @@ int main(int argc, char *argv[])
     // Process the command line options
     if (isDebugOn) showDebug = true;
 
-    // Load the source video metadata
+    // Load the source video metadata.  The decoders only use the primary
+    // field values, so the VBI, VITS, NTSC and drop-out sections are skipped
     LdDecodeMetaData metaData;
-    if (!metaData.read(inputFileName + ".json")) {
+    metaData.setLoadedFieldSections(LdDecodeMetaData::FieldSections());
+    if (!metaData.read(inputJsonFileName)) {
         qInfo() << "Unable to open ld-decode metadata file";
         return -1;
     }
@@ -344,6 +435,12 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // The overlays are drawn in RGB
+    if ((combConfig.showOpticalFlowMap || palConfig.showFFTs) && pixelFormat != OutputFrameLayout::RGB48) {
+        qCritical() << "Can only show optical flow or FFTs with rgb48 output";
+        return -1;
+    }
+
     // Select the decoder
     QScopedPointer<Decoder> decoder;
     if (decoderName == "pal2d") {
@@ -367,7 +464,8 @@ int main(int argc, char *argv[])
     }
 
     // Perform the processing
-    DecoderPool decoderPool(*decoder, inputFileName, metaData, outputFileName, startFrame, length, maxThreads);
+    DecoderPool decoderPool(*decoder, inputFileName, metaData, outputFileName, startFrame, length, maxThreads,
+                            pixelFormat, outputY4m, prefetchDepth);
     if (!decoderPool.process()) {
         return -1;
     }
@@ -28,7 +28,8 @@
 #include "decoderpool.h"
 #include "palcolour.h"
 
-bool MonoDecoder::configure(const LdDecodeMetaData::VideoParameters &videoParameters) {
+bool MonoDecoder::configure(const LdDecodeMetaData::VideoParameters &videoParameters,
+                            OutputFrameLayout::PixelFormat pixelFormat) {
     // This decoder works for both PAL and NTSC.
     // Get the active line range from either Comb or PalColour.
     qint32 firstActiveLine, lastActiveLine;
@@ -43,23 +44,27 @@ bool MonoDecoder::configure(const LdDecodeMetaData::VideoParameters &videoParame
     }
 
     // Compute cropping parameters
-    setVideoParameters(config, videoParameters, firstActiveLine, lastActiveLine);
+    setVideoParameters(config, videoParameters, pixelFormat, firstActiveLine, lastActiveLine);
 
     return true;
 }
 
+OutputFrameLayout MonoDecoder::getOutputLayout() const
+{
+    return computeOutputLayout(config);
+}
+
 QThread *MonoDecoder::makeThread(QAtomicInt& abort, DecoderPool& decoderPool) {
     return new MonoThread(abort, decoderPool, config);
 }
 
 MonoThread::MonoThread(QAtomicInt& _abort, DecoderPool& _decoderPool,
                      const MonoDecoder::Configuration &_config, QObject *parent)
-    : DecoderThread(_abort, _decoderPool, parent), config(_config)
+    : DecoderThread(_abort, _decoderPool, parent), config(_config), outputLayout(Decoder::computeOutputLayout(_config))
 {
-    // Resize and clear the output buffer
-    const qint32 frameHeight = (config.videoParameters.fieldHeight * 2) - 1;
-    outputFrame.resize(config.videoParameters.fieldWidth * frameHeight * 6);
-    outputFrame.fill(0);
+    // Allocate the line buffers (there's no chroma, so U and V are always zero)
+    lumaLine.resize(outputLayout.width);
+    zeroLine.fill(0.0, outputLayout.width);
 }
 
 void MonoThread::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
@@ -71,27 +76,23 @@ void MonoThread::decodeFrames(const QVector<SourceField> &inputFields, qint32 st
     const double whiteScale = 65535.0 / (videoParameters.white16bIre - videoParameters.black16bIre);
 
     for (qint32 fieldIndex = startIndex, frameIndex = 0; fieldIndex < endIndex; fieldIndex += 2, frameIndex++) {
+        QByteArray &outputFrame = outputFrames[frameIndex];
+        outputLayout.prepareFrame(outputFrame);
+
         // Interlace the active lines of the two input fields to produce an output frame
         for (qint32 y = config.firstActiveLine; y < config.lastActiveLine; y++) {
             const QByteArray &inputFieldData = (y % 2) == 0 ? inputFields[fieldIndex].data : inputFields[fieldIndex + 1].data;
 
-            // Each quint16 input becomes three quint16 outputs
             const quint16 *inputLine = reinterpret_cast<const quint16 *>(inputFieldData.data())
                                        + ((y / 2) * videoParameters.fieldWidth);
-            quint16 *outputLine =      reinterpret_cast<quint16 *>(outputFrame.data())
-                                       + (y * videoParameters.fieldWidth * 3);
-
-            for (qint32 x = videoParameters.activeVideoStart; x < videoParameters.activeVideoEnd; x++) {
-                const quint16 value = static_cast<quint16>(qBound(0.0, (inputLine[x] - blackOffset) * whiteScale, 65535.0));
 
-                const qint32 outputPos = x * 3;
-                outputLine[outputPos] = value;
-                outputLine[outputPos + 1] = value;
-                outputLine[outputPos + 2] = value;
+            // Scale the input to luma, and convert it to the output format
+            const qint32 start = videoParameters.activeVideoStart;
+            const qint32 count = videoParameters.activeVideoEnd - start;
+            for (qint32 x = 0; x < count; x++) {
+                lumaLine[x] = qBound(0.0, (inputLine[start + x] - blackOffset) * whiteScale, 65535.0);
             }
+            outputLayout.putLine(outputFrame, start, y, count, lumaLine.constData(), zeroLine.constData(), zeroLine.constData());
         }
-
-        // Crop the frame to just the active area
-        outputFrames[frameIndex] = MonoDecoder::cropOutputFrame(config, outputFrame);
     }
 }
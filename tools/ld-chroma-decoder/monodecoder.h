@@ -28,6 +28,7 @@
 #include <QObject>
 #include <QAtomicInt>
 #include <QThread>
+#include <QVector>
 #include <QDebug>
 
 #include "lddecodemetadata.h"
@@ -41,7 +42,9 @@ class DecoderPool;
 // Decoder that passes all input through as luma, for purely monochrome sources
 class MonoDecoder : public Decoder {
 public:
-    bool configure(const LdDecodeMetaData::VideoParameters &videoParameters) override;
+    bool configure(const LdDecodeMetaData::VideoParameters &videoParameters,
+                   OutputFrameLayout::PixelFormat pixelFormat) override;
+    OutputFrameLayout getOutputLayout() const override;
     QThread *makeThread(QAtomicInt& abort, DecoderPool& decoderPool) override;
 
 private:
@@ -64,8 +67,12 @@ private:
     // Settings
     const MonoDecoder::Configuration &config;
 
-    // The frame being assembled
-    QByteArray outputFrame;
+    // Layout of the output frames
+    OutputFrameLayout outputLayout;
+
+    // Line buffers
+    QVector<double> lumaLine;
+    QVector<double> zeroLine;
 };
 
 #endif // MONODECODER
@@ -33,7 +33,8 @@ NtscDecoder::NtscDecoder(const Comb::Configuration &combConfig)
     config.combConfig = combConfig;
 }
 
-bool NtscDecoder::configure(const LdDecodeMetaData::VideoParameters &videoParameters) {
+bool NtscDecoder::configure(const LdDecodeMetaData::VideoParameters &videoParameters,
+                            OutputFrameLayout::PixelFormat pixelFormat) {
     // Ensure the source video is NTSC
     if (videoParameters.isSourcePal) {
         qCritical() << "This decoder is for NTSC video sources only";
@@ -41,7 +42,7 @@ bool NtscDecoder::configure(const LdDecodeMetaData::VideoParameters &videoParame
     }
 
     // Compute cropping parameters
-    setVideoParameters(config, videoParameters, config.combConfig.firstActiveLine, config.combConfig.lastActiveLine);
+    setVideoParameters(config, videoParameters, pixelFormat, config.combConfig.firstActiveLine, config.combConfig.lastActiveLine);
 
     return true;
 }
@@ -56,6 +57,11 @@ qint32 NtscDecoder::getLookBehind() const
     return 0;
 }
 
+OutputFrameLayout NtscDecoder::getOutputLayout() const
+{
+    return computeOutputLayout(config);
+}
+
 QThread *NtscDecoder::makeThread(QAtomicInt& abort, DecoderPool& decoderPool)
 {
     return new NtscThread(abort, decoderPool, config);
@@ -65,24 +71,25 @@ NtscThread::NtscThread(QAtomicInt& _abort, DecoderPool &_decoderPool,
                        const NtscDecoder::Configuration &_config, QObject *parent)
     : DecoderThread(_abort, _decoderPool, parent), config(_config)
 {
-    // Configure NTSC decoder
+    // Configure NTSC decoder to decode straight into the output layout
     comb.updateConfiguration(config.videoParameters, config.combConfig);
+    comb.setOutputLayout(Decoder::computeOutputLayout(config));
 }
 
 void NtscThread::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                               QVector<QByteArray> &outputFrames)
 {
-    // Decode lookahead fields, discarding the result
-    for (qint32 i = 0; i < startIndex; i += 2) {
-        comb.decodeFrame(inputFields[i], inputFields[i + 1]);
+    // In 3D mode, give the comb filter the frame before the first real frame.
+    // If this thread has just decoded that frame as the end of its last
+    // batch, the comb filter will reuse it; otherwise, only the parts that
+    // the 3D filter needs are prepared, so batches are independent of each
+    // other without decoding any frame twice
+    if (startIndex >= 2) {
+        comb.loadPreviousFrame(inputFields[startIndex - 2], inputFields[startIndex - 1]);
     }
 
     // Decode real fields to frames
     for (qint32 i = startIndex, j = 0; i < endIndex; i += 2, j++) {
-        // Filter the frame
-        QByteArray outputData = comb.decodeFrame(inputFields[i], inputFields[i + 1]);
-
-        // The NTSC filter outputs the whole frame, so here we crop it to the required dimensions
-        outputFrames[j] = NtscDecoder::cropOutputFrame(config, outputData);
+        comb.decodeFrame(inputFields[i], inputFields[i + 1], outputFrames[j]);
     }
 }
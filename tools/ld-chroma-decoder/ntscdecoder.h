@@ -45,8 +45,10 @@ class DecoderPool;
 class NtscDecoder : public Decoder {
 public:
     NtscDecoder(const Comb::Configuration &combConfig);
-    bool configure(const LdDecodeMetaData::VideoParameters &videoParameters) override;
+    bool configure(const LdDecodeMetaData::VideoParameters &videoParameters,
+                   OutputFrameLayout::PixelFormat pixelFormat) override;
     qint32 getLookBehind() const override;
+    OutputFrameLayout getOutputLayout() const override;
     QThread *makeThread(QAtomicInt& abort, DecoderPool& decoderPool) override;
 
     // Parameters used by NtscDecoder and NtscThread
@@ -25,74 +25,44 @@
 
 #include "opticalflow.h"
 
+constexpr qint32 OpticalFlow::PYRAMID_LEVELS;
+constexpr qint32 OpticalFlow::BORDER;
+
 OpticalFlow::OpticalFlow()
-    : framesProcessed(0)
 {
 }
 
-// Perform a dense optical flow analysis
-// Input is a vector of 16-bit Y values for the NTSC frame (910x525)
-void OpticalFlow::denseOpticalFlow(const YiqBuffer &yiqBuffer, QVector<qreal> &kValues)
+// Perform a dense optical flow analysis between two frames
+// Input is a pair of 8-bit greyscale images of the area to analyse, with BORDER around them
+void OpticalFlow::denseOpticalFlow(const cv::Mat &previousFrameGrey, const cv::Mat &currentFrameGrey, QVector<float> &kValues)
 {
-    // Convert the buffer of Y values into an OpenCV n-dimensional dense array (cv::Mat)
-    cv::Mat currentFrameGrey = convertYtoMat(yiqBuffer);
-    cv::Mat flow;
-
-    kValues.resize(910 * 525);
-
-    // If we have no previous image, simply copy the current to previous (and set all K values to 1 for 2D)
-    if (framesProcessed > 0) {
-        // Perform the OpenCV compute dense optical flow (Gunnar Farneback’s algorithm)
-        cv::calcOpticalFlowFarneback(previousFrameGrey, currentFrameGrey, flow, 0.5, 4, 2, 3, 7, 1.5, 0);
-
-        // Apply a wide blur to the flow map to prevent the 3D filter from acting on small spots of the image;
-        // also helps a lot with sharp scene transitions and still-frame images due to the averaging effect
-        // on pixel velocity.
-        cv::GaussianBlur(flow, flow, cv::Size(21, 21), 0);
-
-        // Convert to K values
-        for (qint32 y = 0; y < 525; y++) {
-            for (qint32 x = 0; x < 910; x++) {
-                // Get the flow velocity at the current x, y point
-                const cv::Point2f flowatxy = flow.at<cv::Point2f>(y, x);
-
-                // Calculate the difference between x and y to get the relative velocity (in any direction)
-                // We multiply the x velocity by 2 in order to make the motion detection twice as sensitive
-                // in the X direction than the y
-                qreal velocity = calculateDistance(static_cast<qreal>(flowatxy.y), static_cast<qreal>(flowatxy.x) * 2);
-
-                kValues[(910 * y) + x] = qBound(0.0, velocity, 1.0);
-            }
-        }
-    } else kValues.fill(1);
-
-    // Copy the current frame to the previous frame
-    currentFrameGrey.copyTo(previousFrameGrey);
-
-    framesProcessed++;
-}
-
-// Method to convert a qreal vector frame of Y values to an OpenCV n-dimensional dense array (cv::Mat)
-cv::Mat OpticalFlow::convertYtoMat(const YiqBuffer &yiqBuffer)
-{
-    quint8 frame[910 * 525];
-    memset(frame, 0, sizeof(frame));
-
-    // Firstly we have to convert the Y vector of real numbers into quint8
-    // values for cv::calcOpticalFlowFarneback
-    for (qint32 line = 0; line < 525; line++) {
-        for (qint32 pixel = 0; pixel < 910; pixel++) {
-            frame[(line * 910) + pixel] = static_cast<quint8>(yiqBuffer[line][pixel].y / 256.0);
+    const qint32 width = currentFrameGrey.cols - (2 * BORDER);
+    const qint32 height = currentFrameGrey.rows - (2 * BORDER);
+    kValues.resize(width * height);
+
+    // Perform the OpenCV compute dense optical flow (Gunnar Farneback’s algorithm)
+    cv::calcOpticalFlowFarneback(previousFrameGrey, currentFrameGrey, flow, 0.5, PYRAMID_LEVELS, 2, 3, 7, 1.5, 0);
+
+    // Apply a wide blur to the flow map to prevent the 3D filter from acting on small spots of the image;
+    // also helps a lot with sharp scene transitions and still-frame images due to the averaging effect
+    // on pixel velocity.
+    cv::GaussianBlur(flow, flow, cv::Size(21, 21), 0);
+
+    // Convert to K values
+    for (qint32 y = 0; y < height; y++) {
+        const cv::Point2f *flowLine = flow.ptr<cv::Point2f>(y + BORDER) + BORDER;
+        float *kLine = kValues.data() + (width * y);
+
+        for (qint32 x = 0; x < width; x++) {
+            // Calculate the relative velocity (in any direction) from the flow at the current x, y point.
+            // We multiply the x velocity by 2 in order to make the motion detection twice as sensitive
+            // in the X direction than the y
+            const float xVelocity = flowLine[x].x * 2;
+            const float yVelocity = flowLine[x].y;
+            const float velocitySquared = (xVelocity * xVelocity) + (yVelocity * yVelocity);
+
+            // K is the velocity, limited to 1 -- so the square root is only needed below 1
+            kLine[x] = velocitySquared >= 1.0f ? 1.0f : std::sqrt(velocitySquared);
         }
     }
-
-    // Return a Mat y * x in CV_8UC1 format
-    return cv::Mat(525, 910, CV_8UC1, frame).clone();
-}
-
-// This method calculates the distance between points where x is the difference between the x-coordinates
-// and y is the difference between the y coordinates
-qreal OpticalFlow::calculateDistance(qreal yDifference, qreal xDifference)
-{
-    return sqrt((yDifference * yDifference) + (xDifference * xDifference));
 }
@@ -46,15 +46,26 @@ public:
         YIQ pixel[911]; // One line of YIQ data
     };
 
-    void denseOpticalFlow(const YiqBuffer &yiqBuffer, QVector<qreal> &kValues);
+    // Number of levels in the image pyramid used by the flow analysis, below
+    // the full-size image.  Each level halves the size of the one above
+    static constexpr qint32 PYRAMID_LEVELS = 4;
+
+    // The width of the black border that the input images must have around
+    // the area to be analysed.  At the coarsest pyramid level, the flow at
+    // the edges of the area depends on the pixels beyond them, so the border
+    // covers two pixels of that level (2^PYRAMID_LEVELS samples each).  With
+    // a narrower border the flow near the edges changes noticeably with the
+    // border's width; with a wider one it barely changes.  The result is
+    // close to, but not the same as, that of analysing a whole frame
+    static constexpr qint32 BORDER = 2 << PYRAMID_LEVELS;
+
+    // Compare two greyscale images, and produce K values (0 for stationary
+    // to 1 for moving) for the area inside the border
+    void denseOpticalFlow(const cv::Mat &previousFrameGrey, const cv::Mat &currentFrameGrey, QVector<float> &kValues);
 
 private:
-    // Globals used by the opticalFlow3D method
-    cv::Mat previousFrameGrey;
-    qint32 framesProcessed;
-
-    cv::Mat convertYtoMat(const YiqBuffer &yiqBuffer);
-    inline qreal calculateDistance(qreal yDifference, qreal xDifference);
+    // Flow map, reused between frames
+    cv::Mat flow;
 };
 
 #endif // OPTICALFLOW_H
@@ -0,0 +1,195 @@
+/************************************************************************
+
+    outputframelayout.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "outputframelayout.h"
+
+#include <algorithm>
+
+// Y'CbCr code levels for a pixel format, using the ITU-R BT.601 ranges
+// (16-235 for Y', 16-240 for Cb/Cr, at 8 bits) scaled to the format's depth
+struct YCbCrLevels {
+    explicit YCbCrLevels(OutputFrameLayout::PixelFormat pixelFormat) {
+        const double depthScale = pixelFormat == OutputFrameLayout::YUV422P10 ? 4.0 : 256.0;
+        maxValue = (256.0 * depthScale) - 1;
+        yBlack = 16.0 * depthScale;
+        yScale = (219.0 * depthScale) / 65535.0;
+        cZero = 128.0 * depthScale;
+
+        // Convert U/V to Pb/Pr (which have a range of +/- 0.5)
+        cbScale = (2.032 / 1.772) * (224.0 * depthScale) / 65535.0;
+        crScale = (1.140 / 1.402) * (224.0 * depthScale) / 65535.0;
+    }
+
+    // Round and clamp a value to a code
+    quint16 toCode(double value) const {
+        return static_cast<quint16>(qBound(0.0, value + 0.5, maxValue));
+    }
+
+    double maxValue;
+    double yBlack, yScale;
+    double cZero, cbScale, crScale;
+};
+
+OutputFrameLayout OutputFrameLayout::fullFrame(const LdDecodeMetaData::VideoParameters &videoParameters)
+{
+    OutputFrameLayout layout;
+    layout.width = videoParameters.fieldWidth;
+    layout.height = (videoParameters.fieldHeight * 2) - 1;
+    return layout;
+}
+
+QString OutputFrameLayout::getPixelFormatName(PixelFormat pixelFormat)
+{
+    switch (pixelFormat) {
+    case RGB48:
+        return "rgb48";
+    case YUV444P16:
+        return "yuv444p16";
+    case YUV422P10:
+        return "yuv422p10";
+    case GRAY16:
+        return "gray16";
+    }
+
+    return QString();
+}
+
+bool OutputFrameLayout::getPixelFormat(const QString &name, PixelFormat &pixelFormat)
+{
+    for (PixelFormat candidate : {RGB48, YUV444P16, YUV422P10, GRAY16}) {
+        if (name == getPixelFormatName(candidate)) {
+            pixelFormat = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+qint32 OutputFrameLayout::getChromaWidth() const
+{
+    switch (pixelFormat) {
+    case YUV444P16:
+        return width;
+    case YUV422P10:
+        return (width + 1) / 2;
+    default:
+        return 0;
+    }
+}
+
+qint32 OutputFrameLayout::getFrameSize() const
+{
+    qint32 words;
+    if (pixelFormat == RGB48) words = width * height * 3;
+    else words = (width + (2 * getChromaWidth())) * height;
+
+    return words * static_cast<qint32>(sizeof(quint16));
+}
+
+void OutputFrameLayout::prepareFrame(QByteArray &frame) const
+{
+    if (frame.size() == getFrameSize()) return;
+
+    frame.resize(getFrameSize());
+
+    if (pixelFormat == RGB48 || pixelFormat == GRAY16) {
+        frame.fill(0);
+    } else {
+        // Black is not zero in Y'CbCr
+        const YCbCrLevels levels(pixelFormat);
+        quint16 *data = reinterpret_cast<quint16 *>(frame.data());
+        quint16 *chromaData = data + (width * height);
+        std::fill(data, chromaData, levels.toCode(levels.yBlack));
+        std::fill(chromaData, chromaData + (2 * getChromaWidth() * height), levels.toCode(levels.cZero));
+    }
+}
+
+void OutputFrameLayout::putLine(QByteArray &frame, qint32 x, qint32 y, qint32 count,
+                                const double *yLine, const double *uLine, const double *vLine) const
+{
+    assert(count > 0);
+    assert(contains(x, y) && contains(x + count - 1, y));
+
+    quint16 *data = reinterpret_cast<quint16 *>(frame.data());
+    const qint32 column = x - left;
+    const qint32 row = y - top;
+
+    switch (pixelFormat) {
+    case RGB48: {
+        quint16 *out = data + (((row * width) + column) * 3);
+
+        for (qint32 i = 0; i < count; i++) {
+            // Convert YUV to RGB, saturating levels at 0-65535 to prevent overflow.
+            // This conversion is taken from Video Demystified (5th edition) page 18.
+            const double R = qBound(0.0, yLine[i] + (1.140 * vLine[i]),                      65535.0);
+            const double G = qBound(0.0, yLine[i] - (0.395 * uLine[i]) - (0.581 * vLine[i]), 65535.0);
+            const double B = qBound(0.0, yLine[i] + (2.032 * uLine[i]),                      65535.0);
+
+            out[(i * 3) + 0] = static_cast<quint16>(R);
+            out[(i * 3) + 1] = static_cast<quint16>(G);
+            out[(i * 3) + 2] = static_cast<quint16>(B);
+        }
+        break;
+    }
+    case GRAY16: {
+        quint16 *out = data + (row * width) + column;
+
+        for (qint32 i = 0; i < count; i++) {
+            out[i] = static_cast<quint16>(qBound(0.0, yLine[i], 65535.0));
+        }
+        break;
+    }
+    case YUV444P16:
+    case YUV422P10: {
+        const YCbCrLevels levels(pixelFormat);
+        const qint32 chromaWidth = getChromaWidth();
+        quint16 *yOut = data + (row * width) + column;
+        quint16 *cbOut = data + (width * height) + (row * chromaWidth);
+        quint16 *crOut = cbOut + (chromaWidth * height);
+
+        for (qint32 i = 0; i < count; i++) {
+            yOut[i] = levels.toCode(levels.yBlack + (yLine[i] * levels.yScale));
+        }
+
+        if (pixelFormat == YUV444P16) {
+            for (qint32 i = 0; i < count; i++) {
+                cbOut[column + i] = levels.toCode(levels.cZero + (uLine[i] * levels.cbScale));
+                crOut[column + i] = levels.toCode(levels.cZero + (vLine[i] * levels.crScale));
+            }
+        } else {
+            // Average each horizontal pair of chroma samples
+            assert((column % 2) == 0);
+            for (qint32 i = 0; i < count; i += 2) {
+                const qint32 j = qMin(i + 1, count - 1);
+                const double u = (uLine[i] + uLine[j]) / 2;
+                const double v = (vLine[i] + vLine[j]) / 2;
+                cbOut[(column + i) / 2] = levels.toCode(levels.cZero + (u * levels.cbScale));
+                crOut[(column + i) / 2] = levels.toCode(levels.cZero + (v * levels.crScale));
+            }
+        }
+        break;
+    }
+    }
+}
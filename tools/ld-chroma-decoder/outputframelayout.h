@@ -0,0 +1,108 @@
+/************************************************************************
+
+    outputframelayout.h
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef OUTPUTFRAMELAYOUT_H
+#define OUTPUTFRAMELAYOUT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <cassert>
+
+#include "lddecodemetadata.h"
+
+// The layout of an output frame in memory.
+//
+// An output frame is a rectangular window onto the full interlaced frame.
+// ld-analyse uses the whole frame; ld-chroma-decoder uses just the active
+// area plus any padding lines, so the decoders can write straight into the
+// buffer that will be written to the output file.
+//
+// The decoders only write to the active area, so the rest of a frame stays
+// black when its buffer is reused for another frame with the same layout.
+struct OutputFrameLayout {
+    // Pixel formats for the output
+    enum PixelFormat {
+        // Interleaved RGB, 16 bits per component
+        RGB48 = 0,
+        // Planar Y'CbCr 4:4:4, 16 bits per component
+        YUV444P16,
+        // Planar Y'CbCr 4:2:2, 10 bits per component (in 16-bit words)
+        YUV422P10,
+        // Luma only, 16 bits
+        GRAY16
+    };
+
+    PixelFormat pixelFormat = RGB48;
+
+    // Position of the window's top-left corner in the full frame.  The window
+    // may extend beyond the full frame vertically if there is padding
+    qint32 left = 0;
+    qint32 top = 0;
+
+    // Size of the window, in pixels
+    qint32 width = 0;
+    qint32 height = 0;
+
+    // Return a layout covering the whole interlaced frame, in RGB48
+    static OutputFrameLayout fullFrame(const LdDecodeMetaData::VideoParameters &videoParameters);
+
+    // Convert between pixel formats and their names (as used by ffmpeg).
+    // Returns false if the name is not recognised
+    static QString getPixelFormatName(PixelFormat pixelFormat);
+    static bool getPixelFormat(const QString &name, PixelFormat &pixelFormat);
+
+    // Return the width of each chroma plane, in samples (0 if there are none)
+    qint32 getChromaWidth() const;
+
+    // Return the size of a frame in bytes
+    qint32 getFrameSize() const;
+
+    // Make frame the right size for this layout.  A frame that is already the
+    // right size is left alone; otherwise, it is resized and cleared to black
+    void prepareFrame(QByteArray &frame) const;
+
+    // Return true if the pixel at (x, y) in the full frame is in the window
+    bool contains(qint32 x, qint32 y) const {
+        return x >= left && x < left + width && y >= top && y < top + height;
+    }
+
+    // Return a pointer to the pixel at (x, y) in the full frame, which must
+    // be in the window.  Only valid for RGB48 frames
+    quint16 *getPixel(QByteArray &frame, qint32 x, qint32 y) const {
+        assert(pixelFormat == RGB48);
+        assert(contains(x, y));
+        return reinterpret_cast<quint16 *>(frame.data()) + ((((y - top) * width) + (x - left)) * 3);
+    }
+
+    // Convert count pixels of Y'UV to the output format, and store them in
+    // frame starting at (x, y) in the full frame.
+    //
+    // Y is scaled so that black is 0 and white is 65535.  U and V use the
+    // same scale, so R = Y + 1.140V and B = Y + 2.032U.
+    void putLine(QByteArray &frame, qint32 x, qint32 y, qint32 count,
+                 const double *yLine, const double *uLine, const double *vLine) const;
+};
+
+#endif
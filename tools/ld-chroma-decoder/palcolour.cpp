@@ -32,6 +32,7 @@
 
 #include "palcolour.h"
 
+#include "palcolourfilter.h"
 #include "transformpal2d.h"
 #include "transformpal3d.h"
 
@@ -94,6 +95,7 @@ void PalColour::updateConfiguration(const LdDecodeMetaData::VideoParameters &_vi
     // Copy the configuration parameters
     videoParameters = _videoParameters;
     configuration = _configuration;
+    outputLayout = OutputFrameLayout::fullFrame(videoParameters);
 
     // Build the look-up tables
     buildLookUpTables();
@@ -114,6 +116,11 @@ void PalColour::updateConfiguration(const LdDecodeMetaData::VideoParameters &_vi
     configurationSet = true;
 }
 
+void PalColour::setOutputLayout(const OutputFrameLayout &_outputLayout)
+{
+    outputLayout = _outputLayout;
+}
+
 // Private method to build the look up tables
 // must be called by the constructor when the object is created
 void PalColour::buildLookUpTables()
@@ -249,11 +256,9 @@ void PalColour::decodeFrames(const QVector<SourceField> &inputFields, qint32 sta
         transformPal->filterFields(inputFields, startIndex, endIndex, chromaData);
     }
 
-    // Resize and clear the output buffers
-    const qint32 frameHeight = (videoParameters.fieldHeight * 2) - 1;
+    // Prepare the output buffers (only the active area will be written)
     for (qint32 i = 0; i < outputFrames.size(); i++) {
-        outputFrames[i].resize(videoParameters.fieldWidth * frameHeight * 6);
-        outputFrames[i].fill(0);
+        outputLayout.prepareFrame(outputFrames[i]);
     }
 
     for (qint32 i = startIndex, j = 0, k = 0; i < endIndex; i += 2, j += 2, k++) {
@@ -276,7 +281,7 @@ void PalColour::decodeFrames(const QVector<SourceField> &inputFields, qint32 sta
     if (configuration.showFFTs && configuration.chromaFilter != palColourFilter) {
         // Overlay the FFT visualisation
         transformPal->overlayFFT(configuration.showPositionX, configuration.showPositionY,
-                                 inputFields, startIndex, endIndex, outputFrames);
+                                 inputFields, startIndex, endIndex, outputLayout, outputFrames);
     }
 }
 
@@ -428,54 +433,27 @@ void PalColour::decodeLine(const SourceField &inputField, const ChromaSample *ch
     //     inter-line phase registration...
 
     double pu[MAX_WIDTH], qu[MAX_WIDTH], pv[MAX_WIDTH], qv[MAX_WIDTH], py[MAX_WIDTH], qy[MAX_WIDTH];
-    for (qint32 i = videoParameters.activeVideoStart; i < videoParameters.activeVideoEnd; i++) {
-        double PU = 0, QU = 0, PV = 0, QV = 0, PY = 0, QY = 0;
-
-        // Carry out 2D filtering. P and Q are the two arbitrary SINE & COS
-        // phases components. U filters for U, V for V, and Y for Y.
-        //
-        // U and V are the same for lines n ([0]), n+/-2 ([1]), but
-        // differ in sign for n+/-1 ([2]), n+/-3 ([3]) owing to the
-        // forward/backward axis slant.
-
-        for (qint32 b = 0; b <= FILTER_SIZE; b++) {
-            const qint32 l = i - b;
-            const qint32 r = i + b;
-
-            PY += (m[0][r] + m[0][l]) * yfilt[b][0] + (m[1][r] + m[1][l]) * yfilt[b][1];
-            QY += (n[0][r] + n[0][l]) * yfilt[b][0] + (n[1][r] + n[1][l]) * yfilt[b][1];
-
-            PU += (m[0][r] + m[0][l]) * cfilt[b][0] + (m[1][r] + m[1][l]) * cfilt[b][1]
-                    + (n[2][r] + n[2][l]) * cfilt[b][2] + (n[3][r] + n[3][l]) * cfilt[b][3];
-            QU += (n[0][r] + n[0][l]) * cfilt[b][0] + (n[1][r] + n[1][l]) * cfilt[b][1]
-                    - (m[2][r] + m[2][l]) * cfilt[b][2] - (m[3][r] + m[3][l]) * cfilt[b][3];
-            PV += (m[0][r] + m[0][l]) * cfilt[b][0] + (m[1][r] + m[1][l]) * cfilt[b][1]
-                    - (n[2][r] + n[2][l]) * cfilt[b][2] - (n[3][r] + n[3][l]) * cfilt[b][3];
-            QV += (n[0][r] + n[0][l]) * cfilt[b][0] + (n[1][r] + n[1][l]) * cfilt[b][1]
-                    + (m[2][r] + m[2][l]) * cfilt[b][2] + (m[3][r] + m[3][l]) * cfilt[b][3];
-        }
 
-        pu[i] = PU;
-        qu[i] = QU;
-        pv[i] = PV;
-        qv[i] = QV;
-        py[i] = PY;
-        qy[i] = QY;
-    }
+    // Carry out 2D filtering. P and Q are the two arbitrary SINE & COS
+    // phases components. U filters for U, V for V, and Y for Y.
+    //
+    // The Y filter's output is only used when the chroma isn't prefiltered.
+    filterPalColourLine<!PREFILTERED_CHROMA>(m, n, cfilt, yfilt,
+                                             videoParameters.activeVideoStart, videoParameters.activeVideoEnd,
+                                             pu, qu, pv, qv, py, qy);
 
     // Pointer to composite signal data
     const quint16 *comp = reinterpret_cast<const quint16 *>(inputField.data.data()) + (line.number * videoParameters.fieldWidth);
 
-    // Define scan line pointer to output buffer using 16 bit unsigned words
-    quint16 *ptr = reinterpret_cast<quint16 *>(outputFrame.data()
-                                               + (((line.number * 2) + inputField.getOffset()) * videoParameters.fieldWidth * 6));
-
     // Gain for the Y component, to put black at 0 and peak white at 65535
     const double scaledContrast = 65535.0 / (videoParameters.white16bIre - videoParameters.black16bIre);
 
     // Gain for the U/V components
     const double scaledSaturation = (2.0 / line.burstNorm) * chromaGain;
 
+    // Decoded Y'UV, to be converted to the output format
+    double outY[MAX_WIDTH], outU[MAX_WIDTH], outV[MAX_WIDTH];
+
     for (qint32 i = videoParameters.activeVideoStart; i < videoParameters.activeVideoEnd; i++) {
         // Compute luma by...
         double rY;
@@ -498,16 +476,13 @@ void PalColour::decodeLine(const SourceField &inputField, const ChromaSample *ch
         const double rU =            -((pu[i] * line.bp + qu[i] * line.bq)) * scaledSaturation;
         const double rV = line.Vsw * -((qv[i] * line.bp - pv[i] * line.bq)) * scaledSaturation;
 
-        // Convert YUV to RGB, saturating levels at 0-65535 to prevent overflow.
-        // This conversion is taken from Video Demystified (5th edition) page 18.
-        const double R = qBound(0.0, rY + (1.140 * rV),                65535.0);
-        const double G = qBound(0.0, rY - (0.395 * rU) - (0.581 * rV), 65535.0);
-        const double B = qBound(0.0, rY + (2.032 * rU),                65535.0 );
-
-        // Pack the data back into the RGB 16/16/16 buffer
-        const qint32 pp = i * 3; // 3 words per pixel
-        ptr[pp + 0] = static_cast<quint16>(R);
-        ptr[pp + 1] = static_cast<quint16>(G);
-        ptr[pp + 2] = static_cast<quint16>(B);
+        outY[i] = rY;
+        outU[i] = rU;
+        outV[i] = rV;
     }
+
+    // Convert to the output format (e.g. RGB 16/16/16), and write to the output frame
+    const qint32 start = videoParameters.activeVideoStart;
+    outputLayout.putLine(outputFrame, start, (line.number * 2) + inputField.getOffset(),
+                         videoParameters.activeVideoEnd - start, &outY[start], &outU[start], &outV[start]);
 }
@@ -34,6 +34,7 @@
 
 #include "lddecodemetadata.h"
 
+#include "outputframelayout.h"
 #include "sourcefield.h"
 #include "transformpal.h"
 
@@ -76,10 +77,16 @@ public:
     void updateConfiguration(const LdDecodeMetaData::VideoParameters &videoParameters,
                              const Configuration &configuration);
 
+    // Set the layout of the output frames.  updateConfiguration sets this to
+    // the full frame.
+    void setOutputLayout(const OutputFrameLayout &outputLayout);
+
     // Decode two fields to produce an interlaced frame.
     QByteArray decodeFrame(const SourceField &firstField, const SourceField &secondField);
 
-    // Decode a sequence of fields into a sequence of interlaced frames
+    // Decode a sequence of fields into a sequence of interlaced frames.
+    // outputFrames may contain frames previously decoded with the same
+    // layout, which will be reused.
     void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                       QVector<QByteArray> &outputFrames);
 
@@ -117,6 +124,7 @@ private:
     bool configurationSet;
     Configuration configuration;
     LdDecodeMetaData::VideoParameters videoParameters;
+    OutputFrameLayout outputLayout;
 
     // Transform PAL filter
     QScopedPointer<TransformPal> transformPal;
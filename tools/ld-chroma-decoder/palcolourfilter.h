@@ -0,0 +1,86 @@
+/************************************************************************
+
+    palcolourfilter.h
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2018  William Andrew Steer
+    Copyright (C) 2018-2019 Simon Inns
+    Copyright (C) 2019 Adam Sampson
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef PALCOLOURFILTER_H
+#define PALCOLOURFILTER_H
+
+#include <QtGlobal>
+
+// PALcolour's 2D chroma/luma filter, applied to one line.
+//
+// m and n are the input signal multiplied by the sine and cosine reference
+// carriers, as sums of pairs of lines (see PalColour::decodeLine). cfilt and
+// yfilt are one quarter of each filter, TAPS elements wide. For each sample
+// from start to end - 1, the P (sine) and Q (cosine) components of U, V and
+// Y are written to pu/qu, pv/qv and py/qy. m and n must be valid from
+// start - (TAPS - 1) to end + (TAPS - 1).
+//
+// The Y filter is only applied if FILTER_LUMA is true; otherwise py and qy
+// are left alone. testpalcolourfilter checks its impulse and sine responses.
+template <bool FILTER_LUMA, qint32 TAPS, qint32 WIDTH>
+void filterPalColourLine(const double (&m)[4][WIDTH], const double (&n)[4][WIDTH],
+                         const double (&cfilt)[TAPS][4], const double (&yfilt)[TAPS][2],
+                         qint32 start, qint32 end,
+                         double (&pu)[WIDTH], double (&qu)[WIDTH], double (&pv)[WIDTH], double (&qv)[WIDTH],
+                         double (&py)[WIDTH], double (&qy)[WIDTH])
+{
+    for (qint32 i = start; i < end; i++) {
+        double PU = 0, QU = 0, PV = 0, QV = 0, PY = 0, QY = 0;
+
+        // U and V are the same for lines n ([0]), n+/-2 ([1]), but
+        // differ in sign for n+/-1 ([2]), n+/-3 ([3]) owing to the
+        // forward/backward axis slant.
+
+        for (qint32 b = 0; b < TAPS; b++) {
+            const qint32 l = i - b;
+            const qint32 r = i + b;
+
+            const double m0 = m[0][r] + m[0][l], m1 = m[1][r] + m[1][l], m2 = m[2][r] + m[2][l], m3 = m[3][r] + m[3][l];
+            const double n0 = n[0][r] + n[0][l], n1 = n[1][r] + n[1][l], n2 = n[2][r] + n[2][l], n3 = n[3][r] + n[3][l];
+
+            if (FILTER_LUMA) {
+                PY += m0 * yfilt[b][0] + m1 * yfilt[b][1];
+                QY += n0 * yfilt[b][0] + n1 * yfilt[b][1];
+            }
+
+            PU += m0 * cfilt[b][0] + m1 * cfilt[b][1] + n2 * cfilt[b][2] + n3 * cfilt[b][3];
+            QU += n0 * cfilt[b][0] + n1 * cfilt[b][1] - m2 * cfilt[b][2] - m3 * cfilt[b][3];
+            PV += m0 * cfilt[b][0] + m1 * cfilt[b][1] - n2 * cfilt[b][2] - n3 * cfilt[b][3];
+            QV += n0 * cfilt[b][0] + n1 * cfilt[b][1] + m2 * cfilt[b][2] + m3 * cfilt[b][3];
+        }
+
+        pu[i] = PU;
+        qu[i] = QU;
+        pv[i] = PV;
+        qv[i] = QV;
+        if (FILTER_LUMA) {
+            py[i] = PY;
+            qy[i] = QY;
+        }
+    }
+}
+
+#endif // PALCOLOURFILTER_H
@@ -32,7 +32,8 @@ PalDecoder::PalDecoder(const PalColour::Configuration &palConfig)
     config.pal = palConfig;
 }
 
-bool PalDecoder::configure(const LdDecodeMetaData::VideoParameters &videoParameters) {
+bool PalDecoder::configure(const LdDecodeMetaData::VideoParameters &videoParameters,
+                           OutputFrameLayout::PixelFormat pixelFormat) {
     // Ensure the source video is PAL
     if (!videoParameters.isSourcePal) {
         qCritical() << "This decoder is for PAL video sources only";
@@ -40,7 +41,7 @@ bool PalDecoder::configure(const LdDecodeMetaData::VideoParameters &videoParamet
     }
 
     // Compute cropping parameters
-    setVideoParameters(config, videoParameters, config.pal.firstActiveLine, config.pal.lastActiveLine);
+    setVideoParameters(config, videoParameters, pixelFormat, config.pal.firstActiveLine, config.pal.lastActiveLine);
 
     return true;
 }
@@ -55,6 +56,11 @@ qint32 PalDecoder::getLookAhead() const
     return config.pal.getLookAhead();
 }
 
+OutputFrameLayout PalDecoder::getOutputLayout() const
+{
+    return computeOutputLayout(config);
+}
+
 QThread *PalDecoder::makeThread(QAtomicInt& abort, DecoderPool& decoderPool) {
     return new PalThread(abort, decoderPool, config);
 }
@@ -63,20 +69,14 @@ PalThread::PalThread(QAtomicInt& _abort, DecoderPool& _decoderPool,
                      const PalDecoder::Configuration &_config, QObject *parent)
     : DecoderThread(_abort, _decoderPool, parent), config(_config)
 {
-    // Configure PALcolour
+    // Configure PALcolour to decode straight into the output layout
     palColour.updateConfiguration(config.videoParameters, config.pal);
+    palColour.setOutputLayout(Decoder::computeOutputLayout(config));
 }
 
 void PalThread::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                              QVector<QByteArray> &outputFrames)
 {
-    QVector<QByteArray> decodedFrames(outputFrames.size());
-
     // Perform the PALcolour filtering
-    palColour.decodeFrames(inputFields, startIndex, endIndex, decodedFrames);
-
-    for (qint32 i = 0; i < outputFrames.size(); i++) {
-        // Crop the frame to just the active area
-        outputFrames[i] = PalDecoder::cropOutputFrame(config, decodedFrames[i]);
-    }
+    palColour.decodeFrames(inputFields, startIndex, endIndex, outputFrames);
 }
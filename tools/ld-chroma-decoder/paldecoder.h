@@ -44,9 +44,11 @@ class DecoderPool;
 class PalDecoder : public Decoder {
 public:
     PalDecoder(const PalColour::Configuration &palConfig);
-    bool configure(const LdDecodeMetaData::VideoParameters &videoParameters) override;
+    bool configure(const LdDecodeMetaData::VideoParameters &videoParameters,
+                   OutputFrameLayout::PixelFormat pixelFormat) override;
     qint32 getLookBehind() const override;
     qint32 getLookAhead() const override;
+    OutputFrameLayout getOutputLayout() const override;
     QThread *makeThread(QAtomicInt& abort, DecoderPool& decoderPool) override;
 
     // Parameters used by PalDecoder and PalThread
@@ -28,15 +28,10 @@
 RGB::RGB(double _whiteIreLevel, double _blackIreLevel, bool _whitePoint75, bool _blackAndWhite, double _colourBurstMedian)
     : whiteIreLevel(_whiteIreLevel), blackIreLevel(_blackIreLevel), whitePoint75(_whitePoint75),
       blackAndWhite(_blackAndWhite), colourBurstMedian(_colourBurstMedian)
-{
-}
-
-void RGB::convertLine(const YIQ *begin, const YIQ *end, quint16 *out)
 {
     // Factors to scale Y according to the black to white interval
     // (i.e. make the black level 0 and the white level 65535)
-    qreal yBlackLevel = blackIreLevel;
-    qreal yScale = (1.0 / (blackIreLevel - whiteIreLevel)) * -65535;
+    yScale = (1.0 / (blackIreLevel - whiteIreLevel)) * -65535;
 
     if (whitePoint75) {
         // NTSC uses a 75% white point; so here we scale the result by
@@ -53,12 +48,17 @@ void RGB::convertLine(const YIQ *begin, const YIQ *end, quint16 *out)
     // Note: this calculations should be 20 / colourBurstMedian (meaning that the
     // 'normal' colour burst median is 40 IRE (20 * 2).  At the moment this is
     // over saturating, so we are using 36 IRE (18 * 2).
-    qreal iqScale = (18.0 / colourBurstMedian) * 2;
+    iqScale = (18.0 / colourBurstMedian) * 2;
 
     if (blackAndWhite) {
         // Remove the colour components
         iqScale = 0;
     }
+}
+
+void RGB::convertLine(const YIQ *begin, const YIQ *end, quint16 *out)
+{
+    const qreal yBlackLevel = blackIreLevel;
 
     for (const YIQ *yiq = begin; yiq < end; yiq++) {
         double y = yiq->y;
@@ -91,3 +91,23 @@ void RGB::convertLine(const YIQ *begin, const YIQ *end, quint16 *out)
         *out++ = static_cast<quint16>(b);
     }
 }
+
+void RGB::convertLineToYUV(const YIQ *begin, const YIQ *end, double *yOut, double *uOut, double *vOut)
+{
+    const qreal yBlackLevel = blackIreLevel;
+
+    // I and Q are U and V rotated by 33 degrees
+    const double sin33 = 0.545;
+    const double cos33 = 0.839;
+
+    for (const YIQ *yiq = begin; yiq < end; yiq++) {
+        // Scale as in convertLine
+        const double y = qBound(0.0, (yiq->y - yBlackLevel) * yScale, 65535.0);
+        const double i = yiq->i * iqScale;
+        const double q = yiq->q * iqScale;
+
+        *yOut++ = y;
+        *uOut++ = (-sin33 * i) + (cos33 * q);
+        *vOut++ = (cos33 * i) + (sin33 * q);
+    }
+}
@@ -41,14 +41,22 @@ public:
     // colourBurstMedian: 40 IRE burst amplitude measured by ld-decode
     RGB(double whiteIreLevel, double blackIreLevel, bool whitePoint75, bool blackAndWhite, double colourBurstMedian);
 
+    // Convert a line of YIQ to RGB 16-16-16
     void convertLine(const YIQ *begin, const YIQ *end, quint16 *out);
 
+    // Convert a line of YIQ to Y'UV, scaled as for OutputFrameLayout::putLine
+    void convertLineToYUV(const YIQ *begin, const YIQ *end, double *yOut, double *uOut, double *vOut);
+
 private:
     double whiteIreLevel;
     double blackIreLevel;
     bool whitePoint75;
     bool blackAndWhite;
     double colourBurstMedian;
+
+    // Scaling factors for Y and I/Q
+    double yScale;
+    double iqScale;
 };
 
 #endif // RGB_H
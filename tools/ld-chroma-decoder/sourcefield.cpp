@@ -30,12 +30,25 @@ void SourceField::loadFields(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecod
                              qint32 firstFrameNumber, qint32 numFrames,
                              qint32 lookBehindFrames, qint32 lookAheadFrames,
                              QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex)
+{
+    QVector<qint32> fieldNumbers;
+    loadFieldsMetadata(ldDecodeMetaData, firstFrameNumber, numFrames, lookBehindFrames, lookAheadFrames,
+                       fields, fieldNumbers, startIndex, endIndex);
+    loadFieldsData(sourceVideo, fieldNumbers, ldDecodeMetaData.getVideoParameters().black16bIre, fields);
+}
+
+void SourceField::loadFieldsMetadata(LdDecodeMetaData &ldDecodeMetaData,
+                                     qint32 firstFrameNumber, qint32 numFrames,
+                                     qint32 lookBehindFrames, qint32 lookAheadFrames,
+                                     QVector<SourceField> &fields, QVector<qint32> &fieldNumbers,
+                                     qint32 &startIndex, qint32 &endIndex)
 {
     // Work out indexes.
     // fields will contain {lookbehind fields... [startIndex] real fields... [endIndex] lookahead fields...}.
     startIndex = 2 * lookBehindFrames;
     endIndex = startIndex + (2 * numFrames);
     fields.resize(endIndex + (2 * lookAheadFrames));
+    fieldNumbers.resize(fields.size());
 
     // Populate fields
     const qint32 numInputFrames = ldDecodeMetaData.getNumberOfFrames();
@@ -52,17 +65,28 @@ void SourceField::loadFields(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecod
 
         // Fetch the input metadata
         fields[i].field = ldDecodeMetaData.getField(firstFieldNumber);
-        fields[i].data = sourceVideo.getVideoField(firstFieldNumber);
         fields[i + 1].field = ldDecodeMetaData.getField(secondFieldNumber);
-        fields[i + 1].data = sourceVideo.getVideoField(secondFieldNumber);
+        fields[i].frameNumber = frameNumber;
+        fields[i + 1].frameNumber = frameNumber;
 
-        if (useBlankFrame) {
-            // Fill both fields with black
-            const quint16 black = ldDecodeMetaData.getVideoParameters().black16bIre;
-            fields[i].data.fill(black);
-            fields[i + 1].data.fill(black);
-        }
+        // Record which fields' data to load
+        fieldNumbers[i] = useBlankFrame ? -1 : firstFieldNumber;
+        fieldNumbers[i + 1] = useBlankFrame ? -1 : secondFieldNumber;
 
         frameNumber++;
     }
 }
+
+void SourceField::loadFieldsData(SourceVideo &sourceVideo, const QVector<qint32> &fieldNumbers,
+                                 quint16 black, QVector<SourceField> &fields)
+{
+    for (qint32 i = 0; i < fields.size(); i++) {
+        if (fieldNumbers[i] == -1) {
+            // Fill the field with black
+            fields[i].data.resize(sourceVideo.getFieldByteLength());
+            fields[i].data.fill(black);
+        } else {
+            fields[i].data = sourceVideo.getVideoField(fieldNumbers[i]);
+        }
+    }
+}
@@ -36,6 +36,10 @@ struct SourceField {
     LdDecodeMetaData::Field field;
     QByteArray data;
 
+    // The number of the frame this field belongs to (which may be outside the
+    // input file, for black fields), or -1 if not known
+    qint32 frameNumber = -1;
+
     // Load a sequence of frames from the input files.
     //
     // fields will contain {lookbehind fields... [startIndex] real fields... [endIndex] lookahead fields...}.
@@ -45,6 +49,20 @@ struct SourceField {
                            qint32 lookBehindFrames, qint32 lookAheadFrames,
                            QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex);
 
+    // The two halves of loadFields, for callers that must serialise access to
+    // the metadata but want to read the video data in parallel.
+    //
+    // loadFieldsMetadata fills in the metadata for fields, and sets
+    // fieldNumbers to the sequential field number to load for each entry (or
+    // -1 for a black field). loadFieldsData then loads the video data.
+    static void loadFieldsMetadata(LdDecodeMetaData &ldDecodeMetaData,
+                                   qint32 firstFrameNumber, qint32 numFrames,
+                                   qint32 lookBehindFrames, qint32 lookAheadFrames,
+                                   QVector<SourceField> &fields, QVector<qint32> &fieldNumbers,
+                                   qint32 &startIndex, qint32 &endIndex);
+    static void loadFieldsData(SourceVideo &sourceVideo, const QVector<qint32> &fieldNumbers,
+                               quint16 black, QVector<SourceField> &fields);
+
     // Return the vertical offset of this field within the interlaced frame
     // (i.e. 0 for the top field, 1 for the bottom field).
     qint32 getOffset() const {
@@ -0,0 +1,177 @@
+/************************************************************************
+
+    testcomb.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+
+using std::cerr;
+
+#include "comb.h"
+
+// NTSC video parameters, as ld-decode produces at 4fsc
+static LdDecodeMetaData::VideoParameters makeVideoParameters()
+{
+    LdDecodeMetaData::VideoParameters videoParameters;
+    videoParameters.isSourcePal = false;
+    videoParameters.fieldWidth = 910;
+    videoParameters.fieldHeight = 263;
+    videoParameters.colourBurstStart = 78;
+    videoParameters.colourBurstEnd = 110;
+    videoParameters.activeVideoStart = 134;
+    videoParameters.activeVideoEnd = 894;
+    videoParameters.black16bIre = 15360;
+    videoParameters.white16bIre = 51200;
+    videoParameters.sampleRate = 14318181;
+    videoParameters.fsc = 3579545;
+
+    return videoParameters;
+}
+
+// Vertical colour bars, as Y, I and Q in IRE
+struct Bar {
+    double y, i, q;
+};
+static constexpr qint32 NUM_BARS = 6;
+static constexpr Bar BARS[NUM_BARS] = {
+    {75, 0, 0}, {60, -10, -20}, {50, 25, -5}, {40, -20, 15}, {30, 15, 20}, {20, 5, -15},
+};
+
+// Return the bar that sample x is in
+static qint32 getBar(const LdDecodeMetaData::VideoParameters &videoParameters, qint32 x)
+{
+    const qint32 activeWidth = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
+    return qBound(0, ((x - videoParameters.activeVideoStart) * NUM_BARS) / activeWidth, NUM_BARS - 1);
+}
+
+// Encode a field of colour bars with the given phase ID, with the bars'
+// chroma multiplied by chromaScale.  The chroma phase follows the same
+// pattern that Comb::GetLinePhase and Comb::splitIQ decode.
+static SourceField encodeField(const LdDecodeMetaData::VideoParameters &videoParameters, bool isFirstField, qint32 fieldPhaseID,
+                               double chromaScale)
+{
+    SourceField sourceField;
+    sourceField.field.isFirstField = isFirstField;
+    sourceField.field.fieldPhaseID = fieldPhaseID;
+    sourceField.field.medianBurstIRE = 20;
+    sourceField.data.resize(videoParameters.fieldWidth * videoParameters.fieldHeight * 2);
+
+    const double irescale = (videoParameters.white16bIre - videoParameters.black16bIre) / 100.0;
+    const bool isPositivePhaseOnEvenLines = (fieldPhaseID == 1) || (fieldPhaseID == 4);
+    quint16 *data = reinterpret_cast<quint16 *>(sourceField.data.data());
+
+    for (qint32 fieldLine = 0; fieldLine < videoParameters.fieldHeight; fieldLine++) {
+        const bool isEvenLine = (fieldLine % 2) == 0;
+        const double phaseSign = (isEvenLine == isPositivePhaseOnEvenLines) ? 1.0 : -1.0;
+
+        for (qint32 x = 0; x < videoParameters.fieldWidth; x++) {
+            const Bar &bar = BARS[getBar(videoParameters, x)];
+            const double chroma[4] = {bar.q, -bar.i, -bar.q, bar.i};
+            const double value = videoParameters.black16bIre + irescale * (bar.y - (phaseSign * chromaScale * chroma[x % 4]));
+            data[(fieldLine * videoParameters.fieldWidth) + x] = static_cast<quint16>(qBound(0.0, value, 65535.0));
+        }
+    }
+
+    return sourceField;
+}
+
+// Decode several frames of colour bars, and check that the RGB output is
+// within tolerance of the RGB values for the bars.  Each frame has the
+// opposite chroma phase to the one before, as in a real NTSC signal.
+static void testBars(const char *name, const Comb::Configuration &configuration, double chromaScale, qint32 tolerance)
+{
+    cerr << "Decoding colour bars: " << name << "\n";
+
+    const LdDecodeMetaData::VideoParameters videoParameters = makeVideoParameters();
+    Comb comb;
+    comb.updateConfiguration(videoParameters, configuration);
+
+    const SourceField fields[4] = {
+        encodeField(videoParameters, true, 1, chromaScale), encodeField(videoParameters, false, 2, chromaScale),
+        encodeField(videoParameters, true, 3, chromaScale), encodeField(videoParameters, false, 4, chromaScale),
+    };
+
+    // The expected RGB value for each bar, converted as Comb::yiqToRgbFrame does
+    RGB rgb(videoParameters.white16bIre, videoParameters.black16bIre, configuration.whitePoint100,
+            configuration.blackAndWhite, fields[0].field.medianBurstIRE);
+    const double irescale = (videoParameters.white16bIre - videoParameters.black16bIre) / 100.0;
+    quint16 expected[NUM_BARS][3];
+    for (qint32 i = 0; i < NUM_BARS; i++) {
+        const YIQ yiq(videoParameters.black16bIre + (irescale * BARS[i].y),
+                      irescale * chromaScale * BARS[i].i, irescale * chromaScale * BARS[i].q);
+        rgb.convertLine(&yiq, &yiq + 1, expected[i]);
+    }
+
+    // Ignore the samples near the edges of the bars and the picture, where
+    // the filters see more than one colour
+    static constexpr qint32 EDGE_SAMPLES = 20;
+    static constexpr qint32 EDGE_LINES = 4;
+
+    QByteArray outputFrame;
+    for (qint32 frame = 0; frame < 4; frame++) {
+        const qint32 firstField = (frame % 2) * 2;
+        comb.decodeFrame(fields[firstField], fields[firstField + 1], outputFrame);
+        const quint16 *output = reinterpret_cast<const quint16 *>(outputFrame.constData());
+
+        for (qint32 lineNumber = configuration.firstActiveLine + EDGE_LINES;
+             lineNumber < configuration.lastActiveLine - EDGE_LINES; lineNumber++) {
+            for (qint32 x = videoParameters.activeVideoStart + EDGE_SAMPLES;
+                 x < videoParameters.activeVideoEnd - EDGE_SAMPLES; x++) {
+                const qint32 bar = getBar(videoParameters, x);
+                if (getBar(videoParameters, x - EDGE_SAMPLES) != bar || getBar(videoParameters, x + EDGE_SAMPLES) != bar) continue;
+
+                for (qint32 component = 0; component < 3; component++) {
+                    const qint32 value = output[(((lineNumber * videoParameters.fieldWidth) + x) * 3) + component];
+                    if (qAbs(value - expected[bar][component]) > tolerance) {
+                        cerr << "Mismatch in frame " << frame << " on line " << lineNumber << " at " << x
+                             << ", component " << component << ": " << value << ", expected " << expected[bar][component] << "\n";
+                        exit(1);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    // The decoded bars should be within 0.5% of full scale
+    static constexpr qint32 TOLERANCE = 330;
+
+    // Chroma scale that swings the bars from -22 to 115 IRE.  The chroma
+    // buffers hold floats, whose rounding error grows with the value
+    static constexpr double LARGE_CHROMA = 2.6;
+
+    Comb::Configuration configuration;
+    testBars("2D", configuration, 1.0, TOLERANCE);
+    testBars("2D, large chroma", configuration, LARGE_CHROMA, TOLERANCE);
+
+    configuration.use3D = true;
+    configuration.motionMode = Comb::frameDifferenceMode;
+    testBars("3D, frame difference", configuration, 1.0, TOLERANCE);
+    testBars("3D, frame difference, large chroma", configuration, LARGE_CHROMA, TOLERANCE);
+
+    configuration.motionMode = Comb::opticalFlowMode;
+    testBars("3D, optical flow", configuration, 1.0, TOLERANCE);
+
+    return 0;
+}
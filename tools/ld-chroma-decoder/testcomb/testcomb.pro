@@ -0,0 +1,40 @@
+QT -= gui
+
+CONFIG += c++11 testcase
+CONFIG -= app_bundle
+
+SOURCES += \
+    testcomb.cpp \
+    ../opticalflow.cpp \
+    ../outputframelayout.cpp \
+    ../rgb.cpp \
+    ../yiq.cpp
+
+HEADERS += \
+    ../comb.h \
+    ../iirfilter.h \
+    ../opticalflow.h \
+    ../outputframelayout.h \
+    ../rgb.h \
+    ../sourcefield.h \
+    ../yiq.h \
+    ../yiqbuffer.h \
+    ../../../deemp.h \
+    ../../library/tbc/lddecodemetadata.h
+
+INCLUDEPATH += \
+    .. \
+    ../../library/tbc
+
+# Build Comb with the same optimisation flags as ld-chroma-decoder
+VECTORISED_SOURCES = ../comb.cpp
+include(../vectorise.pri)
+
+# Additional include paths to support MacOS compilation
+INCLUDEPATH += "/usr/local/opt/opencv@2/include"
+LIBS += -L"/usr/local/opt/opencv@2/lib"
+
+# Normal open-source OS goodness
+INCLUDEPATH += "/usr/local/include/opencv"
+LIBS += -L"/usr/local/lib"
+LIBS += -lopencv_core -lopencv_imgproc -lopencv_video
@@ -0,0 +1,219 @@
+/************************************************************************
+
+    testpalcolourfilter.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using std::cerr;
+
+#include "palcolourfilter.h"
+
+static constexpr int WIDTH = 1135;
+static constexpr int TAPS = 8;
+
+// The outputs of the filter, in the order they are passed to it
+enum Output { PU, QU, PV, QV, PY, QY, NUM_OUTPUTS };
+static const char *const OUTPUT_NAMES[NUM_OUTPUTS] = {"PU", "QU", "PV", "QV", "PY", "QY"};
+
+struct Buffers {
+    double m[4][WIDTH], n[4][WIDTH];
+    double out[NUM_OUTPUTS][WIDTH];
+};
+
+// Filter coefficients.  Every coefficient has a different value, so using the
+// wrong tap or the wrong column gives a different result
+static double cfilt[TAPS][4], yfilt[TAPS][2];
+
+static void makeCoefficients()
+{
+    for (int b = 0; b < TAPS; b++) {
+        for (int k = 0; k < 4; k++) cfilt[b][k] = 1 + (b * 4) + k;
+        for (int k = 0; k < 2; k++) yfilt[b][k] = 101 + (b * 2) + k;
+    }
+}
+
+// Fill the outputs with a value the filter never produces, so samples it
+// didn't write can be detected
+static constexpr double UNWRITTEN = -12345.0;
+
+template <bool FILTER_LUMA>
+static void runFilter(Buffers &buffers, int start, int end)
+{
+    for (int o = 0; o < NUM_OUTPUTS; o++) {
+        for (int i = 0; i < WIDTH; i++) buffers.out[o][i] = UNWRITTEN;
+    }
+
+    filterPalColourLine<FILTER_LUMA>(buffers.m, buffers.n, cfilt, yfilt, start, end,
+                                     buffers.out[PU], buffers.out[QU], buffers.out[PV], buffers.out[QV],
+                                     buffers.out[PY], buffers.out[QY]);
+}
+
+// Check that an output holds the expected value, with a tolerance relative to
+// the size of the value
+static void check(const char *test, int output, int i, double value, double expected)
+{
+    if (fabs(value - expected) > 1e-9 * (1 + fabs(expected))) {
+        cerr << "Mismatch in " << test << " on " << OUTPUT_NAMES[output] << " at " << i << ": "
+             << value << ", expected " << expected << "\n";
+        exit(1);
+    }
+}
+
+// Check that the filter wrote the samples from start to end, and only those
+// (and that it left the Y outputs alone if it isn't filtering luma)
+static void checkWritten(const char *test, const Buffers &buffers, bool filterLuma, int start, int end)
+{
+    for (int o = 0; o < NUM_OUTPUTS; o++) {
+        const bool isWritten = filterLuma || (o != PY && o != QY);
+        for (int i = 0; i < WIDTH; i++) {
+            if ((buffers.out[o][i] != UNWRITTEN) != (isWritten && i >= start && i < end)) {
+                cerr << "Wrong samples written in " << test << " on " << OUTPUT_NAMES[o] << " at " << i << "\n";
+                exit(1);
+            }
+        }
+    }
+}
+
+// How each of the eight input lines contributes to each output: the
+// coefficient column used (or -1 for none) and its sign.  U and V are the same
+// for lines n ([0]) and n+/-2 ([1]), but differ in sign for n+/-1 ([2]) and
+// n+/-3 ([3]); the Y filter only uses lines n and n+/-2
+struct Response {
+    int column;
+    double sign;
+};
+static const Response M_RESPONSES[4][NUM_OUTPUTS] = {
+    //  PU        QU        PV        QV        PY        QY
+    {{0, +1}, {-1, 0}, {0, +1}, {-1, 0}, {0, +1}, {-1, 0}},  // m[0]
+    {{1, +1}, {-1, 0}, {1, +1}, {-1, 0}, {1, +1}, {-1, 0}},  // m[1]
+    {{-1, 0}, {2, -1}, {-1, 0}, {2, +1}, {-1, 0}, {-1, 0}},  // m[2]
+    {{-1, 0}, {3, -1}, {-1, 0}, {3, +1}, {-1, 0}, {-1, 0}},  // m[3]
+};
+static const Response N_RESPONSES[4][NUM_OUTPUTS] = {
+    //  PU        QU        PV        QV        PY        QY
+    {{-1, 0}, {0, +1}, {-1, 0}, {0, +1}, {-1, 0}, {0, +1}},  // n[0]
+    {{-1, 0}, {1, +1}, {-1, 0}, {1, +1}, {-1, 0}, {1, +1}},  // n[1]
+    {{2, +1}, {-1, 0}, {2, -1}, {-1, 0}, {-1, 0}, {-1, 0}},  // n[2]
+    {{3, +1}, {-1, 0}, {3, -1}, {-1, 0}, {-1, 0}, {-1, 0}},  // n[3]
+};
+
+// Get the coefficient for an output, tap and column
+static double coefficient(int output, int tap, int column)
+{
+    if (output == PY || output == QY) return yfilt[tap][column];
+    else return cfilt[tap][column];
+}
+
+// Put an impulse into each input line in turn.  Each output should be the
+// coefficients of the filter it uses, mirrored around the impulse (with the
+// centre tap counted twice, as it is added from both sides)
+template <bool FILTER_LUMA>
+static void testImpulse(const char *name)
+{
+    cerr << "Impulse response: " << name << "\n";
+
+    static Buffers buffers;
+    const int position = 500;
+    const int start = position - TAPS - 10;
+    const int end = position + TAPS + 10;
+
+    for (int line = 0; line < 8; line++) {
+        const bool isM = line < 4;
+        for (int j = 0; j < 4; j++) {
+            for (int i = 0; i < WIDTH; i++) {
+                buffers.m[j][i] = 0;
+                buffers.n[j][i] = 0;
+            }
+        }
+        if (isM) buffers.m[line][position] = 1;
+        else buffers.n[line - 4][position] = 1;
+
+        runFilter<FILTER_LUMA>(buffers, start, end);
+        checkWritten(name, buffers, FILTER_LUMA, start, end);
+
+        for (int o = 0; o < NUM_OUTPUTS; o++) {
+            if (!FILTER_LUMA && (o == PY || o == QY)) continue;
+
+            const Response &response = isM ? M_RESPONSES[line][o] : N_RESPONSES[line - 4][o];
+            for (int i = start; i < end; i++) {
+                const int tap = abs(i - position);
+                double expected = 0;
+                if (response.column != -1 && tap < TAPS) {
+                    expected = response.sign * coefficient(o, tap, response.column) * (tap == 0 ? 2 : 1);
+                }
+                check(name, o, i, buffers.out[o][i], expected);
+            }
+        }
+    }
+}
+
+// Put a sine wave into the m[0] and n[1] lines.  Each filter's response to
+// a sine wave of frequency w is the sine wave scaled by
+// 2 * sum(coefficient[b] * cos(w * b)) over its taps
+static void testSine()
+{
+    cerr << "Sine response\n";
+
+    static Buffers buffers;
+    const int start = TAPS;
+    const int end = WIDTH - TAPS;
+    const double w = 2 * M_PI / 17.3;
+
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < WIDTH; i++) {
+            buffers.m[j][i] = (j == 0) ? sin(w * i) : 0;
+            buffers.n[j][i] = (j == 1) ? sin(w * i) : 0;
+        }
+    }
+
+    // Gain of each column of the filters at frequency w
+    double cgain[4] = {0, 0, 0, 0}, ygain[2] = {0, 0};
+    for (int b = 0; b < TAPS; b++) {
+        for (int k = 0; k < 4; k++) cgain[k] += 2 * cfilt[b][k] * cos(w * b);
+        for (int k = 0; k < 2; k++) ygain[k] += 2 * yfilt[b][k] * cos(w * b);
+    }
+
+    runFilter<true>(buffers, start, end);
+    checkWritten("sine", buffers, true, start, end);
+
+    for (int i = start; i < end; i++) {
+        check("sine", PU, i, buffers.out[PU][i], cgain[0] * sin(w * i));
+        check("sine", QU, i, buffers.out[QU][i], cgain[1] * sin(w * i));
+        check("sine", PV, i, buffers.out[PV][i], cgain[0] * sin(w * i));
+        check("sine", QV, i, buffers.out[QV][i], cgain[1] * sin(w * i));
+        check("sine", PY, i, buffers.out[PY][i], ygain[0] * sin(w * i));
+        check("sine", QY, i, buffers.out[QY][i], ygain[1] * sin(w * i));
+    }
+}
+
+int main() {
+    makeCoefficients();
+
+    testImpulse<true>("chroma and luma");
+    testImpulse<false>("chroma only");
+    testSine();
+
+    return 0;
+}
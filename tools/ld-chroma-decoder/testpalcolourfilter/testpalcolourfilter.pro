@@ -0,0 +1,11 @@
+CONFIG += c++11 testcase
+CONFIG -= app_bundle
+
+SOURCES += \
+    testpalcolourfilter.cpp
+
+HEADERS += \
+    ../palcolourfilter.h
+
+INCLUDEPATH += \
+    ..
@@ -35,6 +35,7 @@
 #include "lddecodemetadata.h"
 
 #include "framecanvas.h"
+#include "outputframelayout.h"
 #include "sourcefield.h"
 
 // Abstract base class for Transform PAL filters.
@@ -75,17 +76,17 @@ public:
     //
     // The FFT is computed for each field, so this visualises only the first
     // field in each frame. positionX/Y specify the location to visualise in
-    // frame coordinates.
+    // frame coordinates, and layout gives the layout of the RGB frames.
     void overlayFFT(qint32 positionX, qint32 positionY,
                     const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                    QVector<QByteArray> &rgbFrames);
+                    const OutputFrameLayout &layout, QVector<QByteArray> &rgbFrames);
 
 protected:
     // Overlay a visualisation of one field's FFT.
     // Calls back to overlayFFTArrays to draw the arrays.
     virtual void overlayFFTFrame(qint32 positionX, qint32 positionY,
                                  const QVector<SourceField> &inputFields, qint32 fieldIndex,
-                                 QByteArray &rgbFrame) = 0;
+                                 const OutputFrameLayout &layout, QByteArray &rgbFrame) = 0;
 
     void overlayFFTArrays(const fftw_complex *fftIn, const fftw_complex *fftOut,
                           qint32 xSize, qint32 ySize, qint32 zSize, FrameCanvas &canvas);
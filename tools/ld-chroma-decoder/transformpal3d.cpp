@@ -349,7 +349,7 @@ void TransformPal3D::applyFilter()
 
 void TransformPal3D::overlayFFTFrame(qint32 positionX, qint32 positionY,
                                      const QVector<SourceField> &inputFields, qint32 fieldIndex,
-                                     QByteArray &rgbFrame)
+                                     const OutputFrameLayout &layout, QByteArray &rgbFrame)
 {
     // Do nothing if the tile isn't within the frame
     if (positionX < 0 || positionX + XTILE > videoParameters.fieldWidth
@@ -368,7 +368,7 @@ void TransformPal3D::overlayFFTFrame(qint32 positionX, qint32 positionY,
     }
 
     // Create a canvas
-    FrameCanvas canvas(rgbFrame, videoParameters, firstActiveLine, lastActiveLine);
+    FrameCanvas canvas(rgbFrame, layout, videoParameters, firstActiveLine, lastActiveLine);
 
     // Outline the selected tile
     canvas.drawRectangle(positionX - 1, positionY - 1, XTILE + 1, YTILE + 1, FrameCanvas::green);
@@ -54,7 +54,7 @@ protected:
     void applyFilter();
     void overlayFFTFrame(qint32 positionX, qint32 positionY,
                          const QVector<SourceField> &inputFields, qint32 fieldIndex,
-                         QByteArray &rgbFrame) override;
+                         const OutputFrameLayout &layout, QByteArray &rgbFrame) override;
 
     // FFT input and output sizes.
     //
@@ -0,0 +1,22 @@
+# Compile the files listed in VECTORISED_SOURCES with auto-vectorisation.
+#
+# qmake's release build is -O2, which vectorises none of the Comb kernels
+# (GCC 12 only vectorises at -O2 where it is very cheap, and older versions
+# not at all).  -fno-trapping-math lets the compiler turn the selects in
+# Comb::split2D into vector blends; nothing here reads the floating-point
+# exception flags, so the results are the same.
+#
+# qmake has no per-file compiler flags, so these files are built by an extra
+# compiler rather than being listed in SOURCES.  The rest of the target keeps
+# the normal flags.
+gcc|clang {
+    vectorised.input = VECTORISED_SOURCES
+    vectorised.output = ${QMAKE_VAR_OBJECTS_DIR}${QMAKE_FILE_IN_BASE}$${first(QMAKE_EXT_OBJ)}
+    vectorised.commands = $${QMAKE_CXX} $(CXXFLAGS) -ftree-vectorize -fno-trapping-math $(INCPATH) -c ${QMAKE_FILE_IN} -o ${QMAKE_FILE_OUT}
+    vectorised.dependency_type = TYPE_C
+    vectorised.variable_out = OBJECTS
+    vectorised.name = vectorised ${QMAKE_FILE_IN}
+    QMAKE_EXTRA_COMPILERS += vectorised
+} else {
+    SOURCES += $$VECTORISED_SOURCES
+}
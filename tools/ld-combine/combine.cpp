@@ -30,7 +30,7 @@ Combine::Combine(QObject *parent) : QObject(parent)
 }
 
 bool Combine::process(QVector<QString> inputFilenames, QString outputFilename, bool reverse,
-                      qint32 vbiStartFrame, qint32 length, qint32 dodThreshold)
+                      qint32 vbiStartFrame, qint32 length, qint32 dodThreshold, bool compress)
 {
     // Show input filenames
     qInfo() << "Processing" << inputFilenames.size() << "input TBC files:";
@@ -44,6 +44,7 @@ bool Combine::process(QVector<QString> inputFilenames, QString outputFilename, b
     if (vbiStartFrame == -1) qInfo() << "No VBI start frame specified"; else qInfo() << "VBI start frame specified as" << vbiStartFrame;
     if (length == -1) qInfo() << "No frame processing length specified"; else qInfo() << "Frame processing length specified as" << length;
     qInfo() << "Dropout detection threshold is" << dodThreshold;
+    if (compress) qInfo() << "Writing compressed output TBC file";
     qInfo() << "";
 
     // Load the input TBC files
@@ -70,7 +71,7 @@ bool Combine::process(QVector<QString> inputFilenames, QString outputFilename, b
     }
 
     qInfo() << "Processing" << length << "frames starting from VBI frame" << vbiStartFrame;
-    if (!tbcSources.saveSource(outputFilename, vbiStartFrame, length, dodThreshold)) {
+    if (!tbcSources.saveSource(outputFilename, vbiStartFrame, length, dodThreshold, compress)) {
         qCritical() << "Saving source failed!";
         return false;
     }
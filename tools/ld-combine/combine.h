@@ -38,7 +38,7 @@ public:
     explicit Combine(QObject *parent = nullptr);
 
     bool process(QVector<QString> inputFilenames, QString outputFilename, bool reverse,
-                 qint32 vbiStartFrame, qint32 length, qint32 dodThreshold);
+                 qint32 vbiStartFrame, qint32 length, qint32 dodThreshold, bool compress);
 
 private:
     TbcSources tbcSources;
@@ -29,6 +29,7 @@
 
 #include "logging.h"
 #include "combine.h"
+#include "sourcevideo.h"
 
 int main(int argc, char *argv[])
 {
@@ -81,6 +82,14 @@ int main(int argc, char *argv[])
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(lengthOption);
 
+    // Option to write a compressed output TBC file (-z / --compress)
+    QCommandLineOption setCompressOption(QStringList() << "z" << "compress",
+                                       QCoreApplication::translate("main", "Write the output as a compressed TBC file"));
+    parser.addOption(setCompressOption);
+
+    // Option to select the field cache size (--cache)
+    SourceVideo::addCacheSizeOption(parser);
+
     // Positional argument to specify input TBC files
     parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC files (minimum 3)"));
 
@@ -90,9 +99,13 @@ int main(int argc, char *argv[])
     // Process the command line options and arguments given by the user
     parser.process(a);
 
+    // Set the input field cache size (if specified)
+    if (!SourceVideo::applyCacheSizeOption(parser)) return -1;
+
     // Get the options from the parser
     bool isDebugOn = parser.isSet(showDebugOption);
     bool reverse = parser.isSet(setReverseOption);
+    bool compress = parser.isSet(setCompressOption);
 
     // Process the command line options
     if (isDebugOn) setDebug(true); else setDebug(false);
@@ -154,7 +167,7 @@ int main(int argc, char *argv[])
 
     // Process the TBC file
     Combine combine;
-    if (!combine.process(inputFilenames, outputFilename, reverse, vbiStartFrame, length, dodThreshold)) {
+    if (!combine.process(inputFilenames, outputFilename, reverse, vbiStartFrame, length, dodThreshold, compress)) {
         return 1;
     }
 
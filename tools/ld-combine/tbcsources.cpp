@@ -176,23 +176,24 @@ qint32 TbcSources::getMaximumVbiFrameNumber()
 }
 
 // Save the combined sources
-bool TbcSources::saveSource(QString outputFilename, qint32 vbiStartFrame, qint32 length, qint32 dodThreshold)
+bool TbcSources::saveSource(QString outputFilename, qint32 vbiStartFrame, qint32 length, qint32 dodThreshold, bool compress)
 {
     // Open the target
     qInfo() << "Writing TBC target file and JSON...";
 
+    // Create a target metadata object (using video and PCM audio settings from the source)
+    LdDecodeMetaData targetMetadata;
+    LdDecodeMetaData::VideoParameters targetVideoParameters = sourceVideos[0]->ldDecodeMetaData.getVideoParameters();
+
     // Open the target video
-    QFile targetVideo(outputFilename);
-    if (!targetVideo.open(QIODevice::WriteOnly)) {
+    TargetVideo targetVideo;
+    if (!targetVideo.open(outputFilename, targetVideoParameters.fieldWidth * targetVideoParameters.fieldHeight,
+                          compress ? TargetVideo::compressedFormat : TargetVideo::rawFormat)) {
         // Could not open target video file
         qInfo() << "Cannot save target - Error writing target TBC data file to" << outputFilename;
         return false;
     }
 
-    // Create a target metadata object (using video and PCM audio settings from the source)
-    LdDecodeMetaData targetMetadata;
-    LdDecodeMetaData::VideoParameters targetVideoParameters = sourceVideos[0]->ldDecodeMetaData.getVideoParameters();
-
     // Set the number of sequential fields in the target TBC
     targetVideoParameters.numberOfSequentialFields = length * 2;
 
@@ -214,8 +215,8 @@ bool TbcSources::saveSource(QString outputFilename, qint32 vbiStartFrame, qint32
 
         // Store the video data
         bool writeFail = false;
-        if (!targetVideo.write(combinedFrame.firstFieldData.data(), combinedFrame.firstFieldData.size())) writeFail = true;
-        if (!targetVideo.write(combinedFrame.secondFieldData.data(), combinedFrame.secondFieldData.size())) writeFail = true;
+        if (!targetVideo.writeVideoField(combinedFrame.firstFieldData)) writeFail = true;
+        if (!targetVideo.writeVideoField(combinedFrame.secondFieldData)) writeFail = true;
 
         // Was the write successful?
         if (writeFail) {
@@ -231,7 +232,10 @@ bool TbcSources::saveSource(QString outputFilename, qint32 vbiStartFrame, qint32
     targetMetadata.write(outputFilename + ".json");
 
     // Close the target video file
-    targetVideo.close();
+    if (!targetVideo.close()) {
+        qInfo() << "Writing the target TBC file failed!";
+        return false;
+    }
 
     qInfo() << "Process complete";
     return true;
@@ -517,12 +521,12 @@ bool TbcSources::setDiscTypeAndMaxMinFrameVbi(qint32 sourceNumber)
     qint32 clvMin = 1000000;
     qint32 clvMax = 0;
     // Using sequential frame numbering starting from 1
-    for (qint32 seqFrame = 1; seqFrame <= sourceVideos[sourceNumber]->ldDecodeMetaData.getNumberOfFrames(); seqFrame++) {
+    const LdDecodeMetaData &ldDecodeMetaData = sourceVideos[sourceNumber]->ldDecodeMetaData;
+    const qint32 numberOfFrames = ldDecodeMetaData.getNumberOfFrames();
+    for (qint32 seqFrame = 1; seqFrame <= numberOfFrames; seqFrame++) {
         // Get the VBI data and then decode
-        QVector<qint32> vbi1 = sourceVideos[sourceNumber]->ldDecodeMetaData.getFieldVbi(sourceVideos[sourceNumber]->
-                                                                                        ldDecodeMetaData.getFirstFieldNumber(seqFrame)).vbiData;
-        QVector<qint32> vbi2 = sourceVideos[sourceNumber]->ldDecodeMetaData.getFieldVbi(sourceVideos[sourceNumber]->
-                                                                                        ldDecodeMetaData.getSecondFieldNumber(seqFrame)).vbiData;
+        const QVector<qint32> vbi1 = ldDecodeMetaData.getFieldVbi(ldDecodeMetaData.getFirstFieldNumber(seqFrame)).vbiData;
+        const QVector<qint32> vbi2 = ldDecodeMetaData.getFieldVbi(ldDecodeMetaData.getSecondFieldNumber(seqFrame)).vbiData;
         VbiDecoder::Vbi vbi = vbiDecoder.decodeFrame(vbi1[0], vbi1[1], vbi1[2], vbi2[0], vbi2[1], vbi2[2]);
 
         // Look for a complete, valid CAV picture number or CLV time-code
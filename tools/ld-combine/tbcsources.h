@@ -32,6 +32,7 @@
 
 // TBC library includes
 #include "sourcevideo.h"
+#include "targetvideo.h"
 #include "lddecodemetadata.h"
 #include "vbidecoder.h"
 
@@ -43,7 +44,7 @@ public:
 
     bool loadSource(QString filename, bool reverse);
     bool unloadSource();
-    bool saveSource(QString outputFilename, qint32 vbiStartFrame, qint32 length, qint32 dodThreshold);
+    bool saveSource(QString outputFilename, qint32 vbiStartFrame, qint32 length, qint32 dodThreshold, bool compress);
     qint32 getNumberOfAvailableSources();
     qint32 getMinimumVbiFrameNumber();
     qint32 getMaximumVbiFrameNumber();
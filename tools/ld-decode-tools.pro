@@ -4,7 +4,9 @@ TEMPLATE = subdirs
 SUBDIRS = \
     ld-analyse \
     ld-chroma-decoder \
+    ld-chroma-decoder/testcomb \
     ld-chroma-decoder/testfilter \
+    ld-chroma-decoder/testpalcolourfilter \
     ld-combine \
     ld-dropout-correct \
     ld-lds-converter \
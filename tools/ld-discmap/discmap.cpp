@@ -30,12 +30,12 @@ DiscMap::DiscMap(QObject *parent) : QObject(parent)
 }
 
 // Process the disc
-bool DiscMap::process(QString inputFilename, QString outputFilename, bool reverse, bool mapOnly)
+bool DiscMap::process(QString inputFilename, QString outputFilename, bool reverse, bool mapOnly, bool compress)
 {
     if (!loadSource(inputFilename, reverse)) return false;
     if (!mapSource()) return false;
     if (!mapOnly) {
-        if (!saveSource(outputFilename)) return false;
+        if (!saveSource(outputFilename, compress)) return false;
     }
     return true;
 }
@@ -84,15 +84,16 @@ bool DiscMap::mapSource()
 }
 
 // Save the target TBC and JSON
-bool DiscMap::saveSource(QString filename)
+bool DiscMap::saveSource(QString filename, bool compress)
 {
     // Write the target files
     qInfo();
     qInfo() << "Writing TBC target file and JSON...";
 
     // Open the target video
-    QFile targetVideo(filename);
-    if (!targetVideo.open(QIODevice::WriteOnly)) {
+    TargetVideo targetVideo;
+    if (!targetVideo.open(filename, sourceVideo.getFieldByteLength() / 2,
+                          compress ? TargetVideo::compressedFormat : TargetVideo::rawFormat)) {
             // Could not open target video file
             qInfo() << "Cannot save target - Error writing target TBC data file to" << filename;
             sourceVideo.close();
@@ -122,8 +123,8 @@ bool DiscMap::saveSource(QString filename)
         // Get the source frame field data
         if (vbiMapper.getFrame(frameElement).isMissing) {
             // Missing frame - generate dummy output
-            if (!targetVideo.write(missingFieldData.data(), missingFieldData.size())) writeFail = true;
-            if (!targetVideo.write(missingFieldData.data(), missingFieldData.size())) writeFail = true;
+            if (!targetVideo.writeVideoField(missingFieldData)) writeFail = true;
+            if (!targetVideo.writeVideoField(missingFieldData)) writeFail = true;
 
             // Generate dummy target field metadata
             LdDecodeMetaData::Field firstSourceMetadata;
@@ -186,16 +187,16 @@ bool DiscMap::saveSource(QString filename)
             // Write the fields into the output TBC file in the same order as the source file
             if (firstFieldNumber < secondFieldNumber) {
                 // Save the first field and then second field to the output file
-                if (!targetVideo.write(firstSourceField.data(), firstSourceField.size())) writeFail = true;
-                if (!targetVideo.write(secondSourceField.data(), secondSourceField.size())) writeFail = true;
+                if (!targetVideo.writeVideoField(firstSourceField)) writeFail = true;
+                if (!targetVideo.writeVideoField(secondSourceField)) writeFail = true;
 
                 // Add the metadata
                 targetMetadata.appendField(firstSourceMetadata);
                 targetMetadata.appendField(secondSourceMetadata);
             } else {
                 // Save the second field and then first field to the output file
-                if (!targetVideo.write(secondSourceField.data(), secondSourceField.size())) writeFail = true;
-                if (!targetVideo.write(firstSourceField.data(), firstSourceField.size())) writeFail = true;
+                if (!targetVideo.writeVideoField(secondSourceField)) writeFail = true;
+                if (!targetVideo.writeVideoField(firstSourceField)) writeFail = true;
 
                 // Add the metadata
                 targetMetadata.appendField(secondSourceMetadata);
@@ -231,7 +232,11 @@ bool DiscMap::saveSource(QString filename)
     targetMetadata.write(filename + ".json");
 
     // Close the source and target video files
-    targetVideo.close();
+    if (!targetVideo.close()) {
+        qInfo() << "Writing the target TBC file failed";
+        sourceVideo.close();
+        return false;
+    }
     sourceVideo.close();
 
     qInfo() << "Process complete";
@@ -33,6 +33,7 @@
 
 // TBC library includes
 #include "sourcevideo.h"
+#include "targetvideo.h"
 #include "lddecodemetadata.h"
 
 class DiscMap : public QObject
@@ -40,7 +41,7 @@ class DiscMap : public QObject
     Q_OBJECT
 public:
     explicit DiscMap(QObject *parent = nullptr);
-    bool process(QString inputFilename, QString outputFilename, bool reverse, bool mapOnly);
+    bool process(QString inputFilename, QString outputFilename, bool reverse, bool mapOnly, bool compress);
 
 private:
     SourceVideo sourceVideo;
@@ -49,7 +50,7 @@ private:
 
     bool loadSource(QString filename, bool reverse);
     bool mapSource();
-    bool saveSource(QString filename);
+    bool saveSource(QString filename, bool compress);
 
     qint32 convertFrameToVbi(qint32 frameNumber);
     qint32 convertFrameToClvPicNo(qint32 frameNumber);
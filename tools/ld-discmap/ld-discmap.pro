@@ -15,8 +15,13 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    ../library/tbc/jsonreader.cpp \
+    ../library/tbc/jsonwriter.cpp \
     ../library/tbc/lddecodemetadata.cpp \
+    ../library/tbc/fieldcache.cpp \
+    ../library/tbc/fieldcompressor.cpp \
     ../library/tbc/sourcevideo.cpp \
+    ../library/tbc/targetvideo.cpp \
     ../library/tbc/vbidecoder.cpp \
     discmap.cpp \
     logging.cpp \
@@ -24,8 +29,13 @@ SOURCES += \
     vbimapper.cpp
 
 HEADERS += \
+    ../library/tbc/jsonreader.h \
+    ../library/tbc/jsonwriter.h \
     ../library/tbc/lddecodemetadata.h \
+    ../library/tbc/fieldcache.h \
+    ../library/tbc/fieldcompressor.h \
     ../library/tbc/sourcevideo.h \
+    ../library/tbc/targetvideo.h \
     ../library/tbc/vbidecoder.h \
     discmap.h \
     logging.h \
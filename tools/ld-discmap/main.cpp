@@ -29,6 +29,7 @@
 
 #include "logging.h"
 #include "discmap.h"
+#include "sourcevideo.h"
 
 int main(int argc, char *argv[])
 {
@@ -68,6 +69,14 @@ int main(int argc, char *argv[])
                                        QCoreApplication::translate("main", "Only perform mapping, but do not save to target (for testing purposes)"));
     parser.addOption(setMapOnlyOption);
 
+    // Option to write a compressed output TBC file (-z / --compress)
+    QCommandLineOption setCompressOption(QStringList() << "z" << "compress",
+                                       QCoreApplication::translate("main", "Write the output as a compressed TBC file"));
+    parser.addOption(setCompressOption);
+
+    // Option to select the field cache size (--cache)
+    SourceVideo::addCacheSizeOption(parser);
+
     // Positional argument to specify input TBC file
     parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file"));
 
@@ -77,10 +86,14 @@ int main(int argc, char *argv[])
     // Process the command line options and arguments given by the user
     parser.process(a);
 
+    // Set the input field cache size (if specified)
+    if (!SourceVideo::applyCacheSizeOption(parser)) return -1;
+
     // Get the options from the parser
     bool isDebugOn = parser.isSet(showDebugOption);
     bool reverse = parser.isSet(setReverseOption);
     bool mapOnly = parser.isSet(setMapOnlyOption);
+    bool compress = parser.isSet(setCompressOption);
 
     // Process the command line options
     QString inputFilename;
@@ -118,7 +131,7 @@ int main(int argc, char *argv[])
 
     // Process the TBC file
     DiscMap discMap;
-    if (!discMap.process(inputFilename, outputFilename, reverse, mapOnly)) {
+    if (!discMap.process(inputFilename, outputFilename, reverse, mapOnly, compress)) {
         return 1;
     }
 
@@ -108,14 +108,15 @@ bool VbiMapper::discCheck(LdDecodeMetaData &ldDecodeMetaData)
     qInfo() << "Performing initial disc check...";
 
     // Report number of available frames in the source
-    qInfo() << "Source contains" << ldDecodeMetaData.getNumberOfFrames() << "sequential frames";
+    qint32 numberOfFrames = ldDecodeMetaData.getNumberOfFrames();
+    qInfo() << "Source contains" << numberOfFrames << "sequential frames";
 
-    if (ldDecodeMetaData.getNumberOfFrames() < 2) {
+    if (numberOfFrames < 2) {
         qInfo() << "Source file is too small to be valid! - Cannot map";
         return false;
     }
 
-    if (ldDecodeMetaData.getNumberOfFrames() > 100000) {
+    if (numberOfFrames > 100000) {
         qInfo() << "Source file is too large to be valid! - Cannot map";
         return false;
     }
@@ -129,7 +130,7 @@ bool VbiMapper::discCheck(LdDecodeMetaData &ldDecodeMetaData)
     // Fail if both picture numbers and timecodes are not available
     discType = discType_unknown;
     qint32 framesToCheck = 100;
-    if (ldDecodeMetaData.getNumberOfFrames() < framesToCheck) framesToCheck = ldDecodeMetaData.getNumberOfFrames();
+    if (numberOfFrames < framesToCheck) framesToCheck = numberOfFrames;
     qDebug() << "VbiMapper::discCheck(): Checking first" << framesToCheck << "sequential frames for disc type determination";
 
     VbiDecoder vbiDecoder;
@@ -138,8 +139,8 @@ bool VbiMapper::discCheck(LdDecodeMetaData &ldDecodeMetaData)
     // Using sequential frame numbering starting from 1
     for (qint32 seqFrame = 1; seqFrame <= framesToCheck; seqFrame++) {
         // Get the VBI data and then decode
-        QVector<qint32> vbi1 = ldDecodeMetaData.getFieldVbi(ldDecodeMetaData.getFirstFieldNumber(seqFrame)).vbiData;
-        QVector<qint32> vbi2 = ldDecodeMetaData.getFieldVbi(ldDecodeMetaData.getSecondFieldNumber(seqFrame)).vbiData;
+        const QVector<qint32> vbi1 = ldDecodeMetaData.getFieldVbi(ldDecodeMetaData.getFirstFieldNumber(seqFrame)).vbiData;
+        const QVector<qint32> vbi2 = ldDecodeMetaData.getFieldVbi(ldDecodeMetaData.getSecondFieldNumber(seqFrame)).vbiData;
         VbiDecoder::Vbi vbi = vbiDecoder.decodeFrame(vbi1[0], vbi1[1], vbi1[2], vbi2[0], vbi2[1], vbi2[2]);
 
         // Look for a complete, valid CAV picture number or CLV time-code
@@ -189,23 +190,24 @@ bool VbiMapper::createInitialMap(LdDecodeMetaData &ldDecodeMetaData)
     bool gotFirstFrame = false; // Used to ensure we only detect lead-in before real frames
 
     // Using sequential frame numbering starting from 1
-    for (qint32 seqFrame = 1; seqFrame <= ldDecodeMetaData.getNumberOfFrames(); seqFrame++) {
+    const qint32 numberOfFrames = ldDecodeMetaData.getNumberOfFrames();
+    for (qint32 seqFrame = 1; seqFrame <= numberOfFrames; seqFrame++) {
         Frame frame;
         // Get the required field numbers
         frame.firstField = ldDecodeMetaData.getFirstFieldNumber(seqFrame);
         frame.secondField = ldDecodeMetaData.getSecondFieldNumber(seqFrame);
 
-        LdDecodeMetaData::Field firstFieldMeta = ldDecodeMetaData.getField(frame.firstField);
-        LdDecodeMetaData::Field secondFieldMeta = ldDecodeMetaData.getField(frame.secondField);
+        const LdDecodeMetaData::Field firstFieldMeta = ldDecodeMetaData.getField(frame.firstField);
+        const LdDecodeMetaData::Field secondFieldMeta = ldDecodeMetaData.getField(frame.secondField);
 
         // Default the other parameters
         frame.isMissing = false;
         frame.isMarkedForDeletion = false;
         frame.isCorruptVbi = false;
 
-        // Get the VBI data
-        QVector<qint32> vbi1 = ldDecodeMetaData.getFieldVbi(frame.firstField).vbiData;
-        QVector<qint32> vbi2 = ldDecodeMetaData.getFieldVbi(frame.secondField).vbiData;
+        // Get the VBI data (already held by the field metadata)
+        const QVector<qint32> &vbi1 = firstFieldMeta.vbi.vbiData;
+        const QVector<qint32> &vbi2 = secondFieldMeta.vbi.vbiData;
 
         // Is the VBI data valid for the frame?
         if (vbi1[0] == -1 || vbi1[1] == -1 || vbi1[2] == -1 || vbi2[0] == -1 || vbi2[1] == -1 || vbi2[2] == -1) {
@@ -223,7 +225,7 @@ bool VbiMapper::createInitialMap(LdDecodeMetaData &ldDecodeMetaData)
             // Lead in frames are discarded
             leadInOrOutFrames++;
             if (vbi.leadIn) qInfo() << "Sequential frame" << seqFrame << "is a lead-in frame";
-        } else if (vbi.leadOut && (seqFrame > (ldDecodeMetaData.getNumberOfFrames() - 20))) {
+        } else if (vbi.leadOut && (seqFrame > (numberOfFrames - 20))) {
             // We only detect a lead out frame if it is within 20 frames of the last frame
             // Lead out frames are discarded
             leadInOrOutFrames++;
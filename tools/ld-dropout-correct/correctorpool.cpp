@@ -24,10 +24,12 @@
 
 #include "correctorpool.h"
 
-CorrectorPool::CorrectorPool(QString _inputFilename, QString _outputFilename, qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData,
-                             bool _reverse, bool _intraField, bool _overCorrect, QObject *parent)
-    : QObject(parent), inputFilename(_inputFilename), outputFilename(_outputFilename), maxThreads(_maxThreads), reverse(_reverse),
-      intraField(_intraField), overCorrect(_overCorrect),  abort(false), ldDecodeMetaData(_ldDecodeMetaData)
+CorrectorPool::CorrectorPool(QString _inputFilename, QString _outputFilename, QString _outputJsonFilename,
+                             qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData,
+                             bool _reverse, bool _intraField, bool _overCorrect, bool _compress, QObject *parent)
+    : QObject(parent), inputFilename(_inputFilename), outputFilename(_outputFilename),
+      outputJsonFilename(_outputJsonFilename), maxThreads(_maxThreads), reverse(_reverse),
+      intraField(_intraField), overCorrect(_overCorrect), compress(_compress), abort(false), ldDecodeMetaData(_ldDecodeMetaData)
 {
 }
 
@@ -63,17 +65,17 @@ bool CorrectorPool::process()
     }
 
     // Open the target video
-    targetVideo.setFileName(outputFilename);
-    if (!targetVideo.open(QIODevice::WriteOnly)) {
+    if (!targetVideo.open(outputFilename, videoParameters.fieldWidth * videoParameters.fieldHeight,
+                          compress ? TargetVideo::compressedFormat : TargetVideo::rawFormat)) {
             // Could not open target video file
             qInfo() << "Unable to open output video file";
             sourceVideo.close();
             return false;
     }
 
-    // Check TBC and JSON field numbers match
+    // Check TBC and JSON field numbers match (this isn't known in advance for a streamed input)
     qInfo() << "Verifying metadata (number of available fields)...";
-    if (sourceVideo.getNumberOfAvailableFields() != ldDecodeMetaData.getNumberOfFields()) {
+    if (!sourceVideo.isStreaming() && sourceVideo.getNumberOfAvailableFields() != ldDecodeMetaData.getNumberOfFields()) {
         qInfo() << "Warning: TBC file contains" << sourceVideo.getNumberOfAvailableFields() <<
                    "fields but the JSON indicates" << ldDecodeMetaData.getNumberOfFields() <<
                    "fields - some fields will be ignored";
@@ -88,7 +90,7 @@ bool CorrectorPool::process()
     if (firstFieldNumber != 1 && secondFieldNumber != 1) {
         QByteArray sourceField;
         sourceField = sourceVideo.getVideoField(1);
-        if (!targetVideo.write(sourceField, sourceField.size())) {
+        if (!targetVideo.writeVideoField(sourceField)) {
             // Could not write to target TBC file
             qInfo() << "Writing first field to the output TBC file failed";
             targetVideo.close();
@@ -133,13 +135,16 @@ bool CorrectorPool::process()
                lastFrameNumber / totalSecs << "FPS )";
 
     qInfo() << "Creating JSON metadata file for drop-out corrected TBC";
-    ldDecodeMetaData.write(outputFilename + ".json");
-
-    qInfo() << "Processing complete";
+    ldDecodeMetaData.write(outputJsonFilename);
 
     // Close the source and target video
     sourceVideo.close();
-    targetVideo.close();
+    if (!targetVideo.close()) {
+        qCritical() << "Writing the output TBC file failed";
+        return false;
+    }
+
+    qInfo() << "Processing complete";
 
     return true;
 }
@@ -170,6 +175,19 @@ bool CorrectorPool::getInputFrame(qint32& frameNumber,
     firstFieldNumber = ldDecodeMetaData.getFirstFieldNumber(frameNumber);
     secondFieldNumber = ldDecodeMetaData.getSecondFieldNumber(frameNumber);
 
+    firstFieldMetadata = ldDecodeMetaData.getField(firstFieldNumber);
+    secondFieldMetadata = ldDecodeMetaData.getField(secondFieldNumber);
+    videoParameters = ldDecodeMetaData.getVideoParameters();
+
+    _reverse = reverse;
+    _intraField = intraField;
+    _overCorrect = overCorrect;
+
+    // SourceVideo is safe to read from multiple threads, so the video data
+    // can be fetched without holding inputMutex -- unless the input is
+    // streamed, in which case frames must be read in order
+    if (!sourceVideo.isStreaming()) locker.unlock();
+
     // Fetch the input data (get the fields in TBC sequence order to save seeking)
     if (firstFieldNumber < secondFieldNumber) {
         firstFieldVideoData = sourceVideo.getVideoField(firstFieldNumber);
@@ -179,14 +197,6 @@ bool CorrectorPool::getInputFrame(qint32& frameNumber,
         firstFieldVideoData = sourceVideo.getVideoField(firstFieldNumber);
     }
 
-    firstFieldMetadata = ldDecodeMetaData.getField(firstFieldNumber);
-    secondFieldMetadata = ldDecodeMetaData.getField(secondFieldNumber);
-    videoParameters = ldDecodeMetaData.getVideoParameters();
-
-    _reverse = reverse;
-    _intraField = intraField;
-    _overCorrect = overCorrect;
-
     return true;
 }
 
@@ -223,12 +233,12 @@ bool CorrectorPool::setOutputFrame(qint32 frameNumber,
         bool writeFail = false;
         if (outputFirstFieldSeqNo < secondFirstFieldSeqNo) {
             // Save the first field and then second field to the output file
-            if (!targetVideo.write(outputFirstTargetFieldData.data(), outputFirstTargetFieldData.size())) writeFail = true;
-            if (!targetVideo.write(outputSecondTargetFieldData.data(), outputSecondTargetFieldData.size())) writeFail = true;
+            if (!targetVideo.writeVideoField(outputFirstTargetFieldData)) writeFail = true;
+            if (!targetVideo.writeVideoField(outputSecondTargetFieldData)) writeFail = true;
         } else {
             // Save the second field and then first field to the output file
-            if (!targetVideo.write(outputSecondTargetFieldData.data(), outputSecondTargetFieldData.size())) writeFail = true;
-            if (!targetVideo.write(outputFirstTargetFieldData.data(), outputFirstTargetFieldData.size())) writeFail = true;
+            if (!targetVideo.writeVideoField(outputSecondTargetFieldData)) writeFail = true;
+            if (!targetVideo.writeVideoField(outputFirstTargetFieldData)) writeFail = true;
         }
 
         // Was the write successful?
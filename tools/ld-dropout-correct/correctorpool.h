@@ -33,6 +33,7 @@
 #include <QThread>
 
 #include "sourcevideo.h"
+#include "targetvideo.h"
 #include "lddecodemetadata.h"
 #include "dropoutcorrect.h"
 
@@ -40,8 +41,10 @@ class CorrectorPool : public QObject
 {
     Q_OBJECT
 public:
-    explicit CorrectorPool(QString _inputFileName, QString _outputFilename, qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData,
-                           bool _reverse, bool _intraField, bool _overCorrect, QObject *parent = nullptr);
+    explicit CorrectorPool(QString _inputFileName, QString _outputFilename, QString _outputJsonFilename,
+                           qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData,
+                           bool _reverse, bool _intraField, bool _overCorrect, bool _compress,
+                           QObject *parent = nullptr);
 
     bool process();
 
@@ -59,10 +62,12 @@ public:
 private:
     QString inputFilename;
     QString outputFilename;
+    QString outputJsonFilename;
     qint32 maxThreads;
     bool reverse;
     bool intraField;
     bool overCorrect;
+    bool compress;
     QElapsedTimer totalTimer;
 
     // Atomic abort flag shared by worker threads; workers watch this, and shut
@@ -74,6 +79,9 @@ private:
     qint32 inputFrameNumber;
     qint32 lastFrameNumber;
     LdDecodeMetaData &ldDecodeMetaData;
+
+    // Input video (safe to read from multiple threads without inputMutex,
+    // unless the input is streamed)
     SourceVideo sourceVideo;
 
     // Output stream information (all guarded by outputMutex while threads are running)
@@ -88,7 +96,7 @@ private:
 
     qint32 outputFrameNumber;
     QMap<qint32, OutputFrame> pendingOutputFrames;
-    QFile targetVideo;
+    TargetVideo targetVideo;
 };
 
 #endif // CORRECTORPOOL_H
@@ -18,14 +18,24 @@ SOURCES += \
     correctorpool.cpp \
     main.cpp \
     dropoutcorrect.cpp \
+    ../library/tbc/jsonreader.cpp \
+    ../library/tbc/jsonwriter.cpp \
     ../library/tbc/lddecodemetadata.cpp \
-    ../library/tbc/sourcevideo.cpp
+    ../library/tbc/fieldcache.cpp \
+    ../library/tbc/fieldcompressor.cpp \
+    ../library/tbc/sourcevideo.cpp \
+    ../library/tbc/targetvideo.cpp
 
 HEADERS += \
     correctorpool.h \
     dropoutcorrect.h \
+    ../library/tbc/jsonreader.h \
+    ../library/tbc/jsonwriter.h \
     ../library/tbc/lddecodemetadata.h \
-    ../library/tbc/sourcevideo.h
+    ../library/tbc/fieldcache.h \
+    ../library/tbc/fieldcompressor.h \
+    ../library/tbc/sourcevideo.h \
+    ../library/tbc/targetvideo.h
 
 # Add external includes to the include path
 INCLUDEPATH += ../library/tbc
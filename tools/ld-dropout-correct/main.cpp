@@ -30,6 +30,7 @@
 
 #include "correctorpool.h"
 #include "dropoutcorrect.h"
+#include "sourcevideo.h"
 
 // Global for debug output
 static bool showDebug = false;
@@ -112,26 +113,50 @@ int main(int argc, char *argv[])
                                        QCoreApplication::translate("main", "Force intrafield correction (default interfield)"));
     parser.addOption(setIntrafieldOption);
 
+    // Option to write a compressed output TBC file (-z)
+    QCommandLineOption setCompressOption(QStringList() << "z" << "compress",
+                                       QCoreApplication::translate("main", "Write the output as a compressed TBC file"));
+    parser.addOption(setCompressOption);
+
     // Option to select the number of threads (-t)
     QCommandLineOption threadsOption(QStringList() << "t" << "threads",
                                         QCoreApplication::translate("main", "Specify the number of concurrent threads (default is the number of logical CPUs)"),
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to specify the input JSON metadata file (needed for piped input)
+    QCommandLineOption inputJsonOption(QStringList() << "input-json",
+                                       QCoreApplication::translate("main", "Specify the input JSON file (default input.json)"),
+                                       QCoreApplication::translate("main", "filename"));
+    parser.addOption(inputJsonOption);
+
+    // Option to specify the output JSON metadata file (needed for piped output)
+    QCommandLineOption outputJsonOption(QStringList() << "output-json",
+                                        QCoreApplication::translate("main", "Specify the output JSON file (default output.json)"),
+                                        QCoreApplication::translate("main", "filename"));
+    parser.addOption(outputJsonOption);
+
+    // Option to select the field cache size (--cache)
+    SourceVideo::addCacheSizeOption(parser);
+
     // Positional argument to specify input video file
-    parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file"));
+    parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file (- for piped input)"));
 
     // Positional argument to specify output video file
-    parser.addPositionalArgument("output", QCoreApplication::translate("main", "Specify output TBC file"));
+    parser.addPositionalArgument("output", QCoreApplication::translate("main", "Specify output TBC file (- for piped output)"));
 
     // Process the command line options and arguments given by the user
     parser.process(a);
 
+    // Set the input field cache size (if specified)
+    if (!SourceVideo::applyCacheSizeOption(parser)) return -1;
+
     // Get the options from the parser
     bool isDebugOn = parser.isSet(showDebugOption);
     bool reverse = parser.isSet(setReverseOption);
     bool intraField = parser.isSet(setIntrafieldOption);
     bool overCorrect = parser.isSet(setOverCorrectOption);
+    bool compress = parser.isSet(setCompressOption);
 
     // Get the arguments from the parser
     qint32 maxThreads = QThread::idealThreadCount();
@@ -157,12 +182,31 @@ int main(int argc, char *argv[])
         return -1;
     }
 
-    if (inputFilename == outputFilename) {
+    if (inputFilename == outputFilename && inputFilename != "-") {
         // Quit with error
         qCritical("Input and output files cannot be the same");
         return -1;
     }
 
+    // Work out the input and output JSON filenames
+    QString inputJsonFilename = inputFilename + ".json";
+    if (parser.isSet(inputJsonOption)) {
+        inputJsonFilename = parser.value(inputJsonOption);
+    } else if (inputFilename == "-") {
+        // Quit with error
+        qCritical("You must specify the input JSON file when using piped input");
+        return -1;
+    }
+
+    QString outputJsonFilename = outputFilename + ".json";
+    if (parser.isSet(outputJsonOption)) {
+        outputJsonFilename = parser.value(outputJsonOption);
+    } else if (outputFilename == "-") {
+        // Quit with error
+        qCritical("You must specify the output JSON file when using piped output");
+        return -1;
+    }
+
     // Process the command line options
     if (isDebugOn) showDebug = true;
 
@@ -170,15 +214,16 @@ int main(int argc, char *argv[])
     LdDecodeMetaData metaData;
 
     // Open the source video metadata
-    qInfo().nospace().noquote() << "Reading JSON metadata from " << inputFilename << ".json";
-    if (!metaData.read(inputFilename + ".json")) {
+    qInfo().nospace().noquote() << "Reading JSON metadata from " << inputJsonFilename;
+    if (!metaData.read(inputJsonFilename)) {
         qCritical() << "Unable to open TBC JSON metadata file";
         return 1;
     }
 
     // Perform the processing
     qInfo() << "Beginning VBI processing...";
-    CorrectorPool correctorPool(inputFilename, outputFilename, maxThreads, metaData, reverse, intraField, overCorrect);
+    CorrectorPool correctorPool(inputFilename, outputFilename, outputJsonFilename, maxThreads, metaData,
+                                reverse, intraField, overCorrect, compress);
     if (!correctorPool.process()) return 1;
 
     // Quit with success
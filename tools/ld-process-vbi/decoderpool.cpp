@@ -24,6 +24,9 @@
 
 #include "decoderpool.h"
 
+// Number of fields processed between writes to the metadata journal
+static constexpr qint32 JOURNAL_FLUSH_INTERVAL = 1000;
+
 DecoderPool::DecoderPool(QString _inputFileName, qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData, QObject *parent)
     : QObject(parent), inputFilename(_inputFileName), maxThreads(_maxThreads), ldDecodeMetaData(_ldDecodeMetaData)
 {
@@ -56,6 +59,7 @@ bool DecoderPool::process()
     // Initialise processing state
     inputFieldNumber = 1;
     lastFieldNumber = ldDecodeMetaData.getNumberOfFields();
+    fieldsSinceJournalFlush = 0;
     totalTimer.start();
 
     // Start a vector of decoding threads to process the video
@@ -74,6 +78,9 @@ bool DecoderPool::process()
 
     // Did any of the threads abort?
     if (abort) {
+        // Keep the fields processed so far in the journal
+        ldDecodeMetaData.closeJournal();
+        qInfo() << "Processing was interrupted - run again with --resume to continue it";
         sourceVideo.close();
         return false;
     }
@@ -86,7 +93,16 @@ bool DecoderPool::process()
     // Write the JSON metadata file
     qInfo() << "Writing JSON metadata file...";
     QString outputFileName = inputFilename + ".json";
-    ldDecodeMetaData.write(outputFileName);
+    if (!ldDecodeMetaData.write(outputFileName)) {
+        // Keep the journal, so the processing can be resumed
+        ldDecodeMetaData.closeJournal();
+        qInfo() << "Run again with --resume to write the processed metadata";
+        sourceVideo.close();
+        return false;
+    }
+
+    // The metadata is complete, so the journal is no longer needed
+    ldDecodeMetaData.removeJournal();
     qInfo() << "VBI processing complete";
 
     // Close the source video
@@ -104,6 +120,11 @@ bool DecoderPool::getInputField(qint32 &fieldNumber, QByteArray& fieldVideoData,
 {
     QMutexLocker locker(&inputMutex);
 
+    // Skip fields that were processed by an interrupted run
+    while (inputFieldNumber <= lastFieldNumber && ldDecodeMetaData.isFieldJournalled(inputFieldNumber)) {
+        inputFieldNumber++;
+    }
+
     if (inputFieldNumber > lastFieldNumber) {
         // No more input fields
         return false;
@@ -115,11 +136,17 @@ bool DecoderPool::getInputField(qint32 &fieldNumber, QByteArray& fieldVideoData,
     // Show what we are about to process
     qDebug() << "DecoderPool::process(): Processing field number" << fieldNumber;
 
-    // Fetch the input data (we require only lines 10 to 21 from the field)
-    fieldVideoData = sourceVideo.getVideoField(fieldNumber, 10, 21);
+    // Fetch the input metadata
     fieldMetadata = ldDecodeMetaData.getField(fieldNumber);
     videoParameters = ldDecodeMetaData.getVideoParameters();
 
+    // SourceVideo is safe to read from multiple threads, so the video data
+    // can be fetched without holding inputMutex
+    locker.unlock();
+
+    // Fetch the input data (we require only lines 10 to 21 from the field)
+    fieldVideoData = sourceVideo.getVideoField(fieldNumber, 10, 21);
+
     return true;
 }
 
@@ -134,6 +161,13 @@ bool DecoderPool::setOutputField(qint32 fieldNumber, LdDecodeMetaData::Field fie
     ldDecodeMetaData.updateFieldVbi(fieldMetadata.vbi, fieldNumber);
     ldDecodeMetaData.updateFieldNtsc(fieldMetadata.ntsc, fieldNumber);
 
+    // Periodically save the processed fields to the journal
+    fieldsSinceJournalFlush++;
+    if (fieldsSinceJournalFlush >= JOURNAL_FLUSH_INTERVAL) {
+        fieldsSinceJournalFlush = 0;
+        if (!ldDecodeMetaData.flushJournal()) return false;
+    }
+
     return true;
 }
 
@@ -66,11 +66,14 @@ private:
     qint32 inputFieldNumber;
     qint32 lastFieldNumber;
     LdDecodeMetaData &ldDecodeMetaData;
+
+    // Input video (safe to read from multiple threads without inputMutex)
     SourceVideo sourceVideo;
 
     // Output stream information (all guarded by outputMutex while threads are running)
     QMutex outputMutex;
     QFile targetJson;
+    qint32 fieldsSinceJournalFlush;
 };
 
 #endif // DECODERPOOL_H
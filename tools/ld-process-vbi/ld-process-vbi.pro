@@ -21,7 +21,11 @@ SOURCES += \
     fmcode.cpp \
     vbidecoder.cpp \
     whiteflag.cpp \
+    ../library/tbc/jsonreader.cpp \
+    ../library/tbc/jsonwriter.cpp \
     ../library/tbc/lddecodemetadata.cpp \
+    ../library/tbc/fieldcache.cpp \
+    ../library/tbc/fieldcompressor.cpp \
     ../library/tbc/sourcevideo.cpp
 
 HEADERS += \
@@ -30,7 +34,11 @@ HEADERS += \
     fmcode.h \
     vbidecoder.h \
     whiteflag.h \
+    ../library/tbc/jsonreader.h \
+    ../library/tbc/jsonwriter.h \
     ../library/tbc/lddecodemetadata.h \
+    ../library/tbc/fieldcache.h \
+    ../library/tbc/fieldcompressor.h \
     ../library/tbc/sourcevideo.h
 
 # Add external includes to the include path
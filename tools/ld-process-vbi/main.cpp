@@ -29,6 +29,7 @@
 #include <QThread>
 
 #include "decoderpool.h"
+#include "sourcevideo.h"
 
 // Global for debug output
 static bool showDebug = false;
@@ -101,21 +102,45 @@ int main(int argc, char *argv[])
                                        QCoreApplication::translate("main", "Do not create a backup of the input JSON metadata"));
     parser.addOption(showNoBackupOption);
 
+    // Option to resume an interrupted run from its journal
+    QCommandLineOption resumeOption(QStringList() << "resume",
+                                       QCoreApplication::translate("main", "Resume an interrupted run from its metadata journal"));
+    parser.addOption(resumeOption);
+
+    // Option to discard the journal of an interrupted run
+    QCommandLineOption restartOption(QStringList() << "restart",
+                                       QCoreApplication::translate("main", "Discard the metadata journal of an interrupted run and start again"));
+    parser.addOption(restartOption);
+
     // Option to select the number of threads (-t)
     QCommandLineOption threadsOption(QStringList() << "t" << "threads",
                                         QCoreApplication::translate("main", "Specify the number of concurrent threads (default is the number of logical CPUs)"),
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to select the field cache size (--cache)
+    SourceVideo::addCacheSizeOption(parser);
+
     // Positional argument to specify input TBC file
     parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file"));
 
     // Process the command line options and arguments given by the user
     parser.process(a);
 
+    // Set the input field cache size (if specified)
+    if (!SourceVideo::applyCacheSizeOption(parser)) return -1;
+
     // Get the options from the parser
     bool debugOn = parser.isSet(showDebugOption);
     bool noBackup = parser.isSet(showNoBackupOption);
+    bool isResuming = parser.isSet(resumeOption);
+    bool isRestarting = parser.isSet(restartOption);
+
+    if (isResuming && isRestarting) {
+        // Quit with error
+        qCritical("Only one of --resume and --restart can be specified");
+        return -1;
+    }
 
     qint32 maxThreads = QThread::idealThreadCount();
     if (parser.isSet(threadsOption)) {
@@ -152,15 +177,44 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    // If a previous run was interrupted, its journal will still exist.  The
+    // input JSON metadata hasn't been changed yet, so when resuming it's
+    // already backed up
+    QString journalFilename = LdDecodeMetaData::getJournalFileName(inputFilename + ".json");
+    if (isResuming && !QFile::exists(journalFilename)) {
+        qCritical().noquote() << "There is no metadata journal to resume from -" << journalFilename << "does not exist";
+        return 1;
+    }
+    if (!isResuming && QFile::exists(journalFilename)) {
+        if (!isRestarting) {
+            qCritical().noquote() << "A previous run was interrupted, leaving the metadata journal" << journalFilename
+                                  << "- use --resume to continue it, or --restart to discard it";
+            return 1;
+        }
+
+        qInfo().nospace().noquote() << "Discarding the metadata journal " << journalFilename;
+        if (!QFile::remove(journalFilename)) {
+            qCritical() << "Unable to remove the metadata journal";
+            return 1;
+        }
+    }
+
     // Perform a backup of the input JSON metadata
-    qInfo().nospace().noquote() << "Backing up JSON metadata to " << inputFilename << ".json.bup";
-    if (!noBackup) {
+    if (!noBackup && !isResuming) {
+        qInfo().nospace().noquote() << "Backing up JSON metadata to " << inputFilename << ".json.bup";
         if (!QFile::copy(inputFilename + ".json", inputFilename + ".json.bup")) {
             qCritical() << "Unable to back-up input JSON metadata file - back-up already exists?";
             return 1;
         }
     }
 
+    // Open the journal, so the processed fields are saved as processing progresses
+    if (isResuming) qInfo().nospace().noquote() << "Resuming interrupted processing from " << journalFilename;
+    if (!metaData.openJournal(journalFilename, inputFilename + ".json")) {
+        qCritical() << "Unable to open the metadata journal";
+        return 1;
+    }
+
     // Perform the processing
     qInfo() << "Beginning VBI processing...";
     DecoderPool decoderPool(inputFilename, maxThreads, metaData);
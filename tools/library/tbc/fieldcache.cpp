@@ -0,0 +1,168 @@
+/************************************************************************
+
+    fieldcache.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "fieldcache.h"
+
+FieldCache::FieldCache(qint64 _maxBytes)
+    : maxBytes(_maxBytes), currentBytes(0), clockHand(0)
+{
+    statistics = Statistics();
+}
+
+// Set the maximum total size of the cached fields in bytes (0 disables the cache)
+void FieldCache::setMaxBytes(qint64 _maxBytes)
+{
+    QMutexLocker locker(&mutex);
+    maxBytes = qMax(static_cast<qint64>(0), _maxBytes);
+    makeSpace(0);
+}
+
+qint64 FieldCache::getMaxBytes()
+{
+    QMutexLocker locker(&mutex);
+    return maxBytes;
+}
+
+qint64 FieldCache::getCurrentBytes()
+{
+    QMutexLocker locker(&mutex);
+    return currentBytes;
+}
+
+// Look up a field.  Returns true and sets fieldData if the field is cached
+bool FieldCache::find(qint32 fieldNumber, QByteArray &fieldData)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = entryIndex.constFind(fieldNumber);
+    if (it == entryIndex.constEnd()) {
+        statistics.misses++;
+        return false;
+    }
+
+    Entry &entry = entries[it.value()];
+    entry.referenced = true;
+    fieldData = entry.data;
+    statistics.hits++;
+    return true;
+}
+
+// Add a field to the cache (replacing any existing copy), evicting other
+// fields if needed to stay within the size limit
+void FieldCache::insert(qint32 fieldNumber, const QByteArray &fieldData)
+{
+    QMutexLocker locker(&mutex);
+
+    // Remove any existing copy
+    auto it = entryIndex.constFind(fieldNumber);
+    if (it != entryIndex.constEnd()) evictEntry(it.value());
+
+    // Make space for the new field (if the field can't fit even in an empty
+    // cache, or everything else is pinned, don't cache it)
+    const qint64 bytes = fieldData.size();
+    if (bytes > maxBytes || !makeSpace(bytes)) return;
+
+    // Find an empty entry
+    qint32 entryNumber;
+    if (!freeEntries.isEmpty()) {
+        entryNumber = freeEntries.takeLast();
+    } else {
+        entryNumber = entries.size();
+        entries.resize(entryNumber + 1);
+    }
+
+    Entry &entry = entries[entryNumber];
+    entry.fieldNumber = fieldNumber;
+    entry.data = fieldData;
+    entry.referenced = true;
+    entryIndex.insert(fieldNumber, entryNumber);
+    currentBytes += bytes;
+}
+
+// Remove all fields from the cache
+void FieldCache::clear()
+{
+    QMutexLocker locker(&mutex);
+
+    entries.clear();
+    freeEntries.clear();
+    entryIndex.clear();
+    currentBytes = 0;
+    clockHand = 0;
+}
+
+FieldCache::Statistics FieldCache::getStatistics()
+{
+    QMutexLocker locker(&mutex);
+    return statistics;
+}
+
+void FieldCache::resetStatistics()
+{
+    QMutexLocker locker(&mutex);
+    statistics = Statistics();
+}
+
+// Remove an entry from the cache.  You must hold mutex to call this
+void FieldCache::evictEntry(qint32 entryNumber)
+{
+    Entry &entry = entries[entryNumber];
+
+    entryIndex.remove(entry.fieldNumber);
+    currentBytes -= entry.data.size();
+    entry.fieldNumber = -1;
+    entry.data.clear();
+    entry.referenced = false;
+    freeEntries.append(entryNumber);
+}
+
+// Evict fields until there is space for the given number of bytes.  You must
+// hold mutex to call this.  Returns false if enough space could not be made
+// because the remaining fields are pinned
+bool FieldCache::makeSpace(qint64 bytes)
+{
+    // The clock hand visits each entry at most twice: once to clear its
+    // referenced flag, and once to evict it
+    qint32 remainingSteps = 2 * entries.size();
+
+    while (currentBytes + bytes > maxBytes && remainingSteps > 0) {
+        if (clockHand >= entries.size()) clockHand = 0;
+        Entry &entry = entries[clockHand];
+
+        if (entry.fieldNumber != -1 && entry.data.isDetached()) {
+            if (entry.referenced) {
+                // Give the field a second chance
+                entry.referenced = false;
+            } else {
+                evictEntry(clockHand);
+                statistics.evictions++;
+            }
+        }
+
+        clockHand++;
+        remainingSteps--;
+    }
+
+    return currentBytes + bytes <= maxBytes;
+}
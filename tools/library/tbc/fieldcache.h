@@ -0,0 +1,86 @@
+/************************************************************************
+
+    fieldcache.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef FIELDCACHE_H
+#define FIELDCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+#include <QtGlobal>
+
+// A cache of video fields with a limit on the total size in bytes, used by
+// SourceVideo.  All methods are thread-safe.
+//
+// Fields are evicted using the CLOCK algorithm (an approximation of LRU).
+// A field is pinned, and will not be evicted, while a consumer still holds a
+// reference to its data (e.g. while it is part of a decoder's batch) - evicting
+// it would not free any memory, and the field is likely to be requested again
+// by a neighbouring batch.  If every field is pinned, new fields are not
+// cached until some are released, so the cache never grows beyond its limit.
+class FieldCache
+{
+public:
+    // Cache statistics
+    struct Statistics {
+        qint64 hits;            // Fields found in the cache
+        qint64 misses;          // Fields not found in the cache
+        qint64 evictions;       // Fields removed to make space for others
+    };
+
+    explicit FieldCache(qint64 _maxBytes = 0);
+
+    void setMaxBytes(qint64 _maxBytes);
+    qint64 getMaxBytes();
+    qint64 getCurrentBytes();
+
+    bool find(qint32 fieldNumber, QByteArray &fieldData);
+    void insert(qint32 fieldNumber, const QByteArray &fieldData);
+    void clear();
+
+    Statistics getStatistics();
+    void resetStatistics();
+
+private:
+    struct Entry {
+        qint32 fieldNumber = -1;    // -1 if the entry is empty
+        QByteArray data;
+        bool referenced = false;    // Set when used; cleared as the clock hand passes
+    };
+
+    QMutex mutex;
+    qint64 maxBytes;
+    qint64 currentBytes;
+    QVector<Entry> entries;
+    QVector<qint32> freeEntries;
+    QHash<qint32, qint32> entryIndex;
+    qint32 clockHand;
+    Statistics statistics;
+
+    void evictEntry(qint32 entry);
+    bool makeSpace(qint64 bytes);
+};
+
+#endif // FIELDCACHE_H
@@ -0,0 +1,168 @@
+/************************************************************************
+
+    fieldcompressor.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "fieldcompressor.h"
+
+#include <QtEndian>
+#include <cstring>
+#include <limits>
+
+// Definitions of static constexpr data members, for compatibility with
+// pre-C++17 compilers
+constexpr qint32 FieldCompressor::HEADER_SIZE;
+constexpr qint32 FieldCompressor::TRAILER_SIZE;
+
+const char FieldCompressor::HEADER_MAGIC[8] = {'L', 'D', 'T', 'B', 'C', 'Z', '0', '1'};
+const char FieldCompressor::TRAILER_MAGIC[4] = {'T', 'I', 'D', 'X'};
+
+// Field compression methods ------------------------------------------------------------------------------------------
+
+// Compress a field of 16-bit samples into a record
+QByteArray FieldCompressor::compressField(const QByteArray &fieldData, qint32 compressionLevel)
+{
+    const qint32 samples = fieldData.size() / 2;
+    const quint16 *input = reinterpret_cast<const quint16 *>(fieldData.constData());
+
+    // Delta and zig-zag code the samples, storing the high and low bytes in separate planes
+    QByteArray planes(samples * 2, Qt::Uninitialized);
+    uchar *highPlane = reinterpret_cast<uchar *>(planes.data());
+    uchar *lowPlane = highPlane + samples;
+
+    quint16 previous = 0;
+    for (qint32 i = 0; i < samples; i++) {
+        const quint16 sample = input[i];
+        const qint16 delta = static_cast<qint16>(sample - previous);
+        const quint16 zigZag = static_cast<quint16>((static_cast<quint32>(delta) << 1) ^ static_cast<quint32>(delta >> 15));
+        previous = sample;
+
+        highPlane[i] = static_cast<uchar>(zigZag >> 8);
+        lowPlane[i] = static_cast<uchar>(zigZag & 0xFF);
+    }
+
+    return qCompress(planes, compressionLevel);
+}
+
+// Decompress a field record
+bool FieldCompressor::decompressField(const char *recordData, qint32 recordLength, qint32 fieldByteLength,
+                                      QByteArray &fieldData)
+{
+    QByteArray planes = qUncompress(reinterpret_cast<const uchar *>(recordData), recordLength);
+    if (planes.size() != fieldByteLength) return false;
+
+    const qint32 samples = fieldByteLength / 2;
+    const uchar *highPlane = reinterpret_cast<const uchar *>(planes.constData());
+    const uchar *lowPlane = highPlane + samples;
+
+    fieldData.resize(fieldByteLength);
+    quint16 *output = reinterpret_cast<quint16 *>(fieldData.data());
+
+    // Reverse the zig-zag and delta coding
+    quint16 previous = 0;
+    for (qint32 i = 0; i < samples; i++) {
+        const quint16 zigZag = static_cast<quint16>((highPlane[i] << 8) | lowPlane[i]);
+        const quint16 delta = static_cast<quint16>((zigZag >> 1) ^ (0 - (zigZag & 1)));
+        previous = static_cast<quint16>(previous + delta);
+        output[i] = previous;
+    }
+
+    return true;
+}
+
+// Container methods --------------------------------------------------------------------------------------------------
+
+// Create the file header
+QByteArray FieldCompressor::makeHeader(qint32 fieldByteLength)
+{
+    QByteArray header(HEADER_SIZE, 0);
+    memcpy(header.data(), HEADER_MAGIC, sizeof(HEADER_MAGIC));
+    qToLittleEndian<quint32>(static_cast<quint32>(fieldByteLength), reinterpret_cast<uchar *>(header.data() + 8));
+
+    return header;
+}
+
+// Check the file header.  Returns false if this isn't a compressed TBC file
+bool FieldCompressor::parseHeader(const QByteArray &header, qint32 &fieldByteLength)
+{
+    if (header.size() < HEADER_SIZE) return false;
+    if (memcmp(header.constData(), HEADER_MAGIC, sizeof(HEADER_MAGIC)) != 0) return false;
+
+    fieldByteLength = static_cast<qint32>(qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(header.constData() + 8)));
+    return true;
+}
+
+// Create the field index
+QByteArray FieldCompressor::makeIndex(const QVector<qint64> &fieldOffsets)
+{
+    QByteArray index(fieldOffsets.size() * 8, 0);
+    for (qint32 i = 0; i < fieldOffsets.size(); i++) {
+        qToLittleEndian<quint64>(static_cast<quint64>(fieldOffsets[i]), reinterpret_cast<uchar *>(index.data() + (i * 8)));
+    }
+
+    return index;
+}
+
+// Create the file trailer
+QByteArray FieldCompressor::makeTrailer(qint64 indexPosition, qint32 numberOfFields)
+{
+    QByteArray trailer(TRAILER_SIZE, 0);
+    qToLittleEndian<quint64>(static_cast<quint64>(indexPosition), reinterpret_cast<uchar *>(trailer.data()));
+    qToLittleEndian<quint32>(static_cast<quint32>(numberOfFields), reinterpret_cast<uchar *>(trailer.data() + 8));
+    memcpy(trailer.data() + 12, TRAILER_MAGIC, sizeof(TRAILER_MAGIC));
+
+    return trailer;
+}
+
+// Check the file trailer.  Returns false if the trailer is missing (e.g. the
+// file was not closed properly)
+bool FieldCompressor::parseTrailer(const QByteArray &trailer, qint64 &indexPosition, qint32 &numberOfFields)
+{
+    if (trailer.size() < TRAILER_SIZE) return false;
+    if (memcmp(trailer.constData() + 12, TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) != 0) return false;
+
+    indexPosition = static_cast<qint64>(qFromLittleEndian<quint64>(reinterpret_cast<const uchar *>(trailer.constData())));
+    numberOfFields = static_cast<qint32>(qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(trailer.constData() + 8)));
+    return true;
+}
+
+// Read the field index (numberOfFields + 1 offsets).  Returns false if the index is invalid
+bool FieldCompressor::parseIndex(const QByteArray &index, qint32 numberOfFields, QVector<qint64> &fieldOffsets)
+{
+    // The size is checked in 64 bits, so a corrupt number of fields can't wrap
+    // around to match it
+    if (numberOfFields < 0 || numberOfFields > index.size() / 8) return false;
+    if ((static_cast<qint64>(numberOfFields) + 1) * 8 != index.size()) return false;
+
+    fieldOffsets.resize(numberOfFields + 1);
+    for (qint32 i = 0; i <= numberOfFields; i++) {
+        fieldOffsets[i] = static_cast<qint64>(qFromLittleEndian<quint64>(reinterpret_cast<const uchar *>(index.constData() + (i * 8))));
+
+        // Offsets must start after the header, and be increasing.  Each
+        // record's length must fit in a qint32
+        if (i == 0 && fieldOffsets[i] < HEADER_SIZE) return false;
+        if (i > 0 && fieldOffsets[i] < fieldOffsets[i - 1]) return false;
+        if (i > 0 && fieldOffsets[i] - fieldOffsets[i - 1] > std::numeric_limits<qint32>::max()) return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,75 @@
+/************************************************************************
+
+    fieldcompressor.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef FIELDCOMPRESSOR_H
+#define FIELDCOMPRESSOR_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+
+// Lossless compression of TBC fields, and the layout of the compressed TBC
+// container used by SourceVideo and TargetVideo.
+//
+// A compressed TBC file contains (all values little-endian):
+//
+//   Header:  char[8] magic "LDTBCZ01", quint32 fieldByteLength, quint32 reserved
+//   Fields:  one compressed record per field, in sequential field order
+//   Index:   quint64 offset of each field record, plus the end offset of the last record
+//   Trailer: quint64 offset of the index, quint32 number of fields, char[4] magic "TIDX"
+//
+// The index is written at the end of the file so that the file can be
+// produced in a single pass (including to a pipe); readers load the index
+// from the trailer, so any field can be located in O(1).
+//
+// Each field is compressed by taking the difference between horizontally
+// adjacent samples, zig-zag mapping the differences to unsigned values,
+// splitting the high and low bytes into separate planes, and compressing the
+// result with zlib (qCompress).
+class FieldCompressor
+{
+public:
+    static constexpr qint32 HEADER_SIZE = 16;
+    static constexpr qint32 TRAILER_SIZE = 16;
+    static const char HEADER_MAGIC[8];
+    static const char TRAILER_MAGIC[4];
+
+    // Compress a field.  Returns the compressed record
+    static QByteArray compressField(const QByteArray &fieldData, qint32 compressionLevel = 1);
+
+    // Decompress a field record into fieldData (which is resized to
+    // fieldByteLength).  Returns false if the record is corrupt
+    static bool decompressField(const char *recordData, qint32 recordLength, qint32 fieldByteLength,
+                                QByteArray &fieldData);
+
+    // Header, index and trailer handling
+    static QByteArray makeHeader(qint32 fieldByteLength);
+    static bool parseHeader(const QByteArray &header, qint32 &fieldByteLength);
+    static QByteArray makeIndex(const QVector<qint64> &fieldOffsets);
+    static QByteArray makeTrailer(qint64 indexPosition, qint32 numberOfFields);
+    static bool parseTrailer(const QByteArray &trailer, qint64 &indexPosition, qint32 &numberOfFields);
+    static bool parseIndex(const QByteArray &index, qint32 numberOfFields, QVector<qint64> &fieldOffsets);
+};
+
+#endif // FIELDCOMPRESSOR_H
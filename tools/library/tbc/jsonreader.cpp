@@ -0,0 +1,348 @@
+/************************************************************************
+
+    jsonreader.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "jsonreader.h"
+
+// Number of bytes read from the input at a time
+static constexpr qint64 READ_BLOCK_SIZE = 256 * 1024;
+
+JsonReader::JsonReader(QIODevice &_input)
+    : input(_input), bufferPosition(0), bufferOffset(0), rawValue(nullptr)
+{
+}
+
+bool JsonReader::hasError() const
+{
+    return !errorMessage.isEmpty();
+}
+
+QString JsonReader::getErrorMessage() const
+{
+    return errorMessage;
+}
+
+// Start reading an object
+void JsonReader::beginObject()
+{
+    skipWhitespace();
+    expect('{');
+    isFirstInContainer.append(true);
+}
+
+// Read the name of the next member of the current object.  Returns false at
+// the end of the object
+bool JsonReader::readMember(QByteArray &name)
+{
+    if (hasError()) return false;
+    if (isFirstInContainer.isEmpty()) {
+        setError("Attempt to read a member outside of an object");
+        return false;
+    }
+
+    skipWhitespace();
+    if (peekChar() == '}') {
+        getChar();
+        isFirstInContainer.removeLast();
+        return false;
+    }
+
+    if (!isFirstInContainer.last()) {
+        expect(',');
+        skipWhitespace();
+    }
+    isFirstInContainer.last() = false;
+
+    if (peekChar() != '"') {
+        setError("Expected a member name");
+        return false;
+    }
+    name.clear();
+    readString(&name);
+    skipWhitespace();
+    expect(':');
+
+    return !hasError();
+}
+
+// Start reading an array
+void JsonReader::beginArray()
+{
+    skipWhitespace();
+    expect('[');
+    isFirstInContainer.append(true);
+}
+
+// Move to the next element of the current array.  Returns false at the end
+// of the array
+bool JsonReader::readElement()
+{
+    if (hasError()) return false;
+    if (isFirstInContainer.isEmpty()) {
+        setError("Attempt to read an element outside of an array");
+        return false;
+    }
+
+    skipWhitespace();
+    if (peekChar() == ']') {
+        getChar();
+        isFirstInContainer.removeLast();
+        return false;
+    }
+
+    if (!isFirstInContainer.last()) expect(',');
+    isFirstInContainer.last() = false;
+
+    return !hasError();
+}
+
+void JsonReader::read(qint32 &value)
+{
+    value = 0;
+    QByteArray literal = readLiteral();
+    if (hasError() || literal == "null" || literal == "false") return;
+    if (literal == "true") {
+        value = 1;
+        return;
+    }
+
+    bool ok;
+    value = static_cast<qint32>(literal.toLongLong(&ok));
+    if (!ok) {
+        // Accept non-integer numbers, as QVariant::toInt() did
+        qreal realValue = literal.toDouble(&ok);
+        value = qRound(realValue);
+    }
+    if (!ok) setError("Invalid number " + QString::fromLatin1(literal));
+}
+
+void JsonReader::read(qreal &value)
+{
+    value = 0.0;
+    QByteArray literal = readLiteral();
+    if (hasError() || literal == "null" || literal == "false") return;
+    if (literal == "true") {
+        value = 1.0;
+        return;
+    }
+
+    bool ok;
+    value = literal.toDouble(&ok);
+    if (!ok) setError("Invalid number " + QString::fromLatin1(literal));
+}
+
+void JsonReader::read(bool &value)
+{
+    value = false;
+    QByteArray literal = readLiteral();
+    if (hasError() || literal == "null" || literal == "false") return;
+    if (literal == "true") {
+        value = true;
+        return;
+    }
+
+    bool ok;
+    value = literal.toDouble(&ok) != 0.0;
+    if (!ok) setError("Invalid boolean " + QString::fromLatin1(literal));
+}
+
+// Skip over the next value, including any nested objects or arrays
+void JsonReader::discard()
+{
+    skipWhitespace();
+
+    char c = peekChar();
+    if (c == '"') {
+        readString(nullptr);
+    } else if (c == '{' || c == '[') {
+        qint32 depth = 0;
+        do {
+            c = peekChar();
+            if (c == '"') {
+                readString(nullptr);
+                continue;
+            }
+
+            getChar();
+            if (c == '{' || c == '[') depth++;
+            else if (c == '}' || c == ']') depth--;
+            else if (c == '\0') setError("Unexpected end of file");
+        } while (depth > 0 && !hasError());
+    } else {
+        readLiteral();
+    }
+}
+
+// Read the next value as JSON text.  This skips over the value in the same
+// way as discard(), keeping each character that is consumed
+void JsonReader::readRaw(QByteArray &json)
+{
+    json.clear();
+    skipWhitespace();
+
+    rawValue = &json;
+    discard();
+    rawValue = nullptr;
+}
+
+// Private methods ----------------------------------------------------------------------------------------------------
+
+// Read the next block of input into the buffer.  Returns false at the end of
+// the input
+bool JsonReader::fillBuffer()
+{
+    if (hasError()) return false;
+
+    bufferOffset += buffer.size();
+    bufferPosition = 0;
+    buffer = input.read(READ_BLOCK_SIZE);
+
+    return !buffer.isEmpty();
+}
+
+// Get the next character without consuming it ('\0' at the end of the input)
+inline char JsonReader::peekChar()
+{
+    if (bufferPosition >= buffer.size() && !fillBuffer()) return '\0';
+    return buffer.constData()[bufferPosition];
+}
+
+// Get and consume the next character ('\0' at the end of the input)
+inline char JsonReader::getChar()
+{
+    if (bufferPosition >= buffer.size() && !fillBuffer()) return '\0';
+    const char c = buffer.constData()[bufferPosition++];
+    if (rawValue != nullptr) rawValue->append(c);
+    return c;
+}
+
+void JsonReader::skipWhitespace()
+{
+    forever {
+        char c = peekChar();
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') break;
+        bufferPosition++;
+    }
+}
+
+void JsonReader::expect(char expected)
+{
+    if (hasError()) return;
+
+    char c = getChar();
+    if (c != expected) {
+        if (c == '\0') setError("Unexpected end of file");
+        else setError(QString("Expected '%1' but found '%2'").arg(expected).arg(c));
+    }
+}
+
+// Read a string, storing its UTF-8 value in value (unless it is nullptr)
+void JsonReader::readString(QByteArray *value)
+{
+    expect('"');
+
+    while (!hasError()) {
+        char c = getChar();
+        if (c == '"') return;
+
+        if (static_cast<uchar>(c) < 0x20) {
+            if (c == '\0') setError("Unexpected end of file in string");
+            else setError("Invalid control character in string");
+            return;
+        }
+
+        if (c != '\\') {
+            if (value != nullptr) value->append(c);
+            continue;
+        }
+
+        // Escape sequence
+        c = getChar();
+        switch (c) {
+        case '"': case '\\': case '/': break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'u': {
+            // Read the UTF-16 code unit, and the second half of a surrogate pair if there is one
+            auto readCodeUnit = [this]() {
+                QByteArray hex;
+                for (qint32 i = 0; i < 4; i++) hex.append(getChar());
+                bool ok;
+                ushort codeUnit = hex.toUShort(&ok, 16);
+                if (!ok) setError("Invalid unicode escape in string");
+                return QChar(codeUnit);
+            };
+
+            QString utf16(readCodeUnit());
+            if (utf16.at(0).isHighSurrogate() && peekChar() == '\\') {
+                getChar();
+                if (getChar() != 'u') setError("Invalid unicode escape in string");
+                else utf16.append(readCodeUnit());
+            }
+
+            if (value != nullptr) value->append(utf16.toUtf8());
+            continue;
+        }
+        default:
+            setError("Invalid escape sequence in string");
+            return;
+        }
+
+        if (value != nullptr) value->append(c);
+    }
+}
+
+// Read a number or true/false/null
+QByteArray JsonReader::readLiteral()
+{
+    skipWhitespace();
+
+    QByteArray literal;
+    forever {
+        char c = peekChar();
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E')) break;
+        literal.append(c);
+        bufferPosition++;
+    }
+
+    if (rawValue != nullptr) rawValue->append(literal);
+
+    if (literal.isEmpty() && !hasError()) {
+        char c = peekChar();
+        if (c == '\0') setError("Unexpected end of file");
+        else setError(QString("Expected a value but found '%1'").arg(c));
+    }
+
+    return literal;
+}
+
+void JsonReader::setError(const QString &message)
+{
+    // Keep the first error, as later ones are usually caused by it
+    if (hasError()) return;
+
+    errorMessage = QString("%1 at byte %2").arg(message).arg(bufferOffset + bufferPosition);
+}
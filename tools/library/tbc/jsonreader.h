@@ -0,0 +1,95 @@
+/************************************************************************
+
+    jsonreader.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// A streaming (pull) JSON reader, used to read the metadata straight into
+// native structures without building a document tree in memory.  The input
+// is read in blocks, so memory use does not depend on the size of the file.
+//
+// The caller walks the document in order, e.g.:
+//
+//     reader.beginObject();
+//     while (reader.readMember(name)) {
+//         if (name == "value") reader.read(value);
+//         else reader.discard();
+//     }
+//
+// Once an error has occurred, all further calls do nothing (readMember and
+// readElement return false) and hasError() returns true.
+class JsonReader
+{
+public:
+    JsonReader(QIODevice &_input);
+
+    bool hasError() const;
+    QString getErrorMessage() const;
+
+    // Objects and arrays.  readMember and readElement return false (and
+    // consume the closing bracket) at the end of the object or array
+    void beginObject();
+    bool readMember(QByteArray &name);
+    void beginArray();
+    bool readElement();
+
+    // Scalar values.  Numbers and booleans are converted between each other,
+    // and null reads as zero/false
+    void read(qint32 &value);
+    void read(qreal &value);
+    void read(bool &value);
+
+    // Skip over the next value (of any type)
+    void discard();
+
+    // Read the next value (of any type) as JSON text, so it can be written
+    // back unchanged
+    void readRaw(QByteArray &json);
+
+private:
+    QIODevice &input;
+    QByteArray buffer;
+    qint32 bufferPosition;
+    qint64 bufferOffset;
+    QVector<bool> isFirstInContainer;
+    QString errorMessage;
+    QByteArray *rawValue;
+
+    bool fillBuffer();
+    inline char peekChar();
+    inline char getChar();
+    void skipWhitespace();
+    void expect(char expected);
+    void readString(QByteArray *value);
+    QByteArray readLiteral();
+    void setError(const QString &message);
+};
+
+#endif // JSONREADER_H
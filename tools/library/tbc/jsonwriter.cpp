@@ -0,0 +1,142 @@
+/************************************************************************
+
+    jsonwriter.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "jsonwriter.h"
+
+#include <QLocale>
+#include <QtMath>
+
+// Size the output buffer may reach before it is written to the device
+static constexpr qint32 WRITE_BLOCK_SIZE = 256 * 1024;
+
+JsonWriter::JsonWriter(QIODevice &_output)
+    : output(_output), isAfterMember(false), isError(false)
+{
+    buffer.reserve(WRITE_BLOCK_SIZE + 1024);
+}
+
+// Write any buffered output to the device.  Returns false if any write failed
+bool JsonWriter::flush()
+{
+    if (!buffer.isEmpty() && !isError) {
+        if (output.write(buffer) != buffer.size()) isError = true;
+    }
+    buffer.clear();
+
+    return !isError;
+}
+
+bool JsonWriter::hasError() const
+{
+    return isError;
+}
+
+void JsonWriter::beginObject()
+{
+    beginValue();
+    buffer.append('{');
+    isFirstInContainer.append(true);
+}
+
+void JsonWriter::endObject()
+{
+    isFirstInContainer.removeLast();
+    buffer.append('}');
+    flushIfFull();
+}
+
+void JsonWriter::beginArray()
+{
+    beginValue();
+    buffer.append('[');
+    isFirstInContainer.append(true);
+}
+
+void JsonWriter::endArray()
+{
+    isFirstInContainer.removeLast();
+    buffer.append(']');
+    flushIfFull();
+}
+
+void JsonWriter::writeMember(const char *name)
+{
+    if (!isFirstInContainer.last()) buffer.append(',');
+    isFirstInContainer.last() = false;
+
+    buffer.append('"');
+    buffer.append(name);
+    buffer.append("\":");
+    isAfterMember = true;
+}
+
+void JsonWriter::write(qint32 value)
+{
+    beginValue();
+    buffer.append(QByteArray::number(value));
+}
+
+void JsonWriter::write(qreal value)
+{
+    beginValue();
+
+    // JSON cannot represent infinity or NaN
+    if (qIsFinite(value)) buffer.append(QByteArray::number(value, 'g', QLocale::FloatingPointShortest));
+    else buffer.append("null");
+}
+
+void JsonWriter::write(bool value)
+{
+    beginValue();
+    buffer.append(value ? "true" : "false");
+}
+
+void JsonWriter::writeRawMembers(const QByteArray &members)
+{
+    if (members.isEmpty()) return;
+
+    if (!isFirstInContainer.last()) buffer.append(',');
+    isFirstInContainer.last() = false;
+
+    buffer.append(members);
+    flushIfFull();
+}
+
+// Private methods ----------------------------------------------------------------------------------------------------
+
+// Write the separator needed before a value
+void JsonWriter::beginValue()
+{
+    if (isAfterMember) {
+        isAfterMember = false;
+    } else if (!isFirstInContainer.isEmpty()) {
+        if (!isFirstInContainer.last()) buffer.append(',');
+        isFirstInContainer.last() = false;
+    }
+}
+
+void JsonWriter::flushIfFull()
+{
+    if (buffer.size() >= WRITE_BLOCK_SIZE) flush();
+}
@@ -0,0 +1,85 @@
+/************************************************************************
+
+    jsonwriter.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QVector>
+#include <QtGlobal>
+
+// A streaming JSON writer, producing compact JSON.  Output is buffered and
+// written to the device incrementally as the document is generated, so the
+// whole document is never held in memory.
+//
+// Member names are written as given, so they must not need escaping (which
+// is true of all the names used in the metadata).  flush() must be called
+// once the document is complete.
+class JsonWriter
+{
+public:
+    JsonWriter(QIODevice &_output);
+
+    bool flush();
+    bool hasError() const;
+
+    // Objects and arrays
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    // Write the name of an object member; the member's value must follow
+    void writeMember(const char *name);
+
+    // Scalar values
+    void write(qint32 value);
+    void write(qreal value);
+    void write(bool value);
+
+    // Write members of the current object that are given as JSON text
+    // ("name":value pairs, separated by commas), such as those kept by
+    // JsonReader::readRaw()
+    void writeRawMembers(const QByteArray &members);
+
+    // Write an object member and its value
+    template <typename T>
+    void writeMember(const char *name, T value) {
+        writeMember(name);
+        write(value);
+    }
+
+private:
+    QIODevice &output;
+    QByteArray buffer;
+    QVector<bool> isFirstInContainer;
+    bool isAfterMember;
+    bool isError;
+
+    void beginValue();
+    void flushIfFull();
+};
+
+#endif // JSONWRITER_H
@@ -23,28 +23,68 @@
 ************************************************************************/
 
 #include "lddecodemetadata.h"
+#include "jsonreader.h"
+#include "jsonwriter.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstring>
 
 LdDecodeMetaData::LdDecodeMetaData(QObject *parent) : QObject(parent)
 {
     // Set defaults
     isFirstFieldFirst = false;
+    metaData.videoParameters = VideoParameters();
+    metaData.pcmAudioParameters = PcmAudioParameters();
+    hasVideoParameters = false;
+    hasPcmAudioParameters = false;
+    isFrameIndexValid = false;
+    loadedFieldSections = AllFieldSections;
 }
 
-// This method opens the JSON metadata file and reads the content into the
-// metadata structure read for use
-bool LdDecodeMetaData::read(QString fileName)
+// Set which optional sections of the field metadata are loaded by read().
+// Sections that are not loaded read as not in use (or empty), so metadata
+// read without all of the sections cannot be written back
+void LdDecodeMetaData::setLoadedFieldSections(FieldSections sections)
 {
-    // Open the JSON file
-    qDebug() << "LdDecodeMetaData::read(): Loading JSON file" << fileName;
-    if (!json.loadFile(fileName)) {
-        qCritical() << "JSON wax library error:" << json.errorMsg();
-        qCritical("Opening JSON file failed: JSON file cannot be opened/does not exist");
+    loadedFieldSections = sections;
+}
 
+LdDecodeMetaData::FieldSections LdDecodeMetaData::getLoadedFieldSections() const
+{
+    return loadedFieldSections;
+}
+
+// Check that all of the field metadata was loaded, so it can be written
+bool LdDecodeMetaData::areAllFieldSectionsLoaded(const char *caller) const
+{
+    if (loadedFieldSections != AllFieldSections) {
+        qCritical() << caller << "Cannot write metadata that was read without all of the field sections";
         return false;
     }
 
+    return true;
+}
+
+// This method opens a metadata file and reads the content into the metadata
+// structure ready for use.  The file may be JSON or the binary format (see
+// writeBinary())
+bool LdDecodeMetaData::read(QString fileName)
+{
+    bool success;
+    if (isBinaryFile(fileName)) success = readBinary(fileName);
+    else success = readJson(fileName);
+    if (!success) return false;
+
     // Default to the standard still-frame field order (of first field first)
-    isFirstFieldFirst = true;
+    isFrameIndexValid = false;
+    setIsFirstFieldFirst(true);
 
     return true;
 }
@@ -52,9 +92,298 @@ bool LdDecodeMetaData::read(QString fileName)
 // This method copies the metadata structure into a JSON metadata file
 bool LdDecodeMetaData::write(QString fileName)
 {
-    // Write the JSON object
-    qDebug() << "LdDecodeMetaData::write(): Writing JSON metadata to:" << fileName;
-    if (!json.saveAs(fileName, JsonWax::Compact)) {
+    if (!areAllFieldSectionsLoaded("LdDecodeMetaData::write():")) return false;
+
+    return writeJson(fileName);
+}
+
+// Keep a member of an object that isn't part of the metadata structure, as
+// JSON text appended to otherMembers
+static void readJsonOtherMember(JsonReader &reader, const QByteArray &name, QByteArray &otherMembers)
+{
+    if (!otherMembers.isEmpty()) otherMembers.append(',');
+
+    // The name has been unescaped by the reader, so escape it again
+    otherMembers.append('"');
+    for (char c : name) {
+        if (c == '"' || c == '\\') {
+            otherMembers.append('\\');
+            otherMembers.append(c);
+        } else if (static_cast<uchar>(c) < 0x20) {
+            otherMembers.append("\\u00");
+            otherMembers.append(QByteArray::number(c, 16).rightJustified(2, '0'));
+        } else {
+            otherMembers.append(c);
+        }
+    }
+    otherMembers.append("\":");
+
+    QByteArray value;
+    reader.readRaw(value);
+    otherMembers.append(value);
+}
+
+// Read a JSON metadata file into the metadata structure.  The file is parsed
+// as a stream directly into the native structures, so no document tree is
+// built in memory
+bool LdDecodeMetaData::readJson(QString fileName)
+{
+    // Open the JSON file
+    qDebug() << "LdDecodeMetaData::readJson(): Loading JSON file" << fileName;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical("Opening JSON file failed: JSON file cannot be opened/does not exist");
+        return false;
+    }
+
+    hasVideoParameters = false;
+    hasPcmAudioParameters = false;
+    metaData.videoParameters = VideoParameters();
+    metaData.pcmAudioParameters = PcmAudioParameters();
+    metaData.fields.clear();
+    metaData.otherMembers.clear();
+
+    JsonReader reader(file);
+    QByteArray member;
+    reader.beginObject();
+    while (reader.readMember(member)) {
+        if (member == "videoParameters") {
+            hasVideoParameters = readJsonVideoParameters(reader);
+        } else if (member == "pcmAudioParameters") {
+            hasPcmAudioParameters = readJsonPcmAudioParameters(reader);
+        } else if (member == "fields") {
+            reader.beginArray();
+            while (reader.readElement()) {
+                metaData.fields.append(Field());
+                readJsonField(reader, metaData.fields.last());
+            }
+        } else {
+            readJsonOtherMember(reader, member, metaData.otherMembers);
+        }
+    }
+
+    if (reader.hasError()) {
+        qCritical() << "JSON parse error:" << reader.getErrorMessage();
+        qCritical("Opening JSON file failed: JSON file is invalid");
+        metaData.fields.clear();
+        return false;
+    }
+
+    return true;
+}
+
+// Read the videoParameters object.  Returns false if the object is empty
+bool LdDecodeMetaData::readJsonVideoParameters(JsonReader &reader)
+{
+    VideoParameters &videoParameters = metaData.videoParameters;
+    bool isEmpty = true;
+
+    QByteArray member;
+    reader.beginObject();
+    while (reader.readMember(member)) {
+        isEmpty = false;
+
+        if (member == "numberOfSequentialFields") reader.read(videoParameters.numberOfSequentialFields);
+        else if (member == "isSourcePal") reader.read(videoParameters.isSourcePal);
+        else if (member == "colourBurstStart") reader.read(videoParameters.colourBurstStart);
+        else if (member == "colourBurstEnd") reader.read(videoParameters.colourBurstEnd);
+        else if (member == "activeVideoStart") reader.read(videoParameters.activeVideoStart);
+        else if (member == "activeVideoEnd") reader.read(videoParameters.activeVideoEnd);
+        else if (member == "white16bIre") reader.read(videoParameters.white16bIre);
+        else if (member == "black16bIre") reader.read(videoParameters.black16bIre);
+        else if (member == "fieldWidth") reader.read(videoParameters.fieldWidth);
+        else if (member == "fieldHeight") reader.read(videoParameters.fieldHeight);
+        else if (member == "sampleRate") reader.read(videoParameters.sampleRate);
+        else if (member == "fsc") reader.read(videoParameters.fsc);
+        else if (member == "isMapped") reader.read(videoParameters.isMapped);
+        else readJsonOtherMember(reader, member, videoParameters.otherMembers);
+    }
+
+    return !isEmpty;
+}
+
+// Read the pcmAudioParameters object.  Returns false if the object is empty
+bool LdDecodeMetaData::readJsonPcmAudioParameters(JsonReader &reader)
+{
+    PcmAudioParameters &pcmAudioParameters = metaData.pcmAudioParameters;
+    bool isEmpty = true;
+
+    QByteArray member;
+    reader.beginObject();
+    while (reader.readMember(member)) {
+        isEmpty = false;
+
+        if (member == "sampleRate") reader.read(pcmAudioParameters.sampleRate);
+        else if (member == "isLittleEndian") reader.read(pcmAudioParameters.isLittleEndian);
+        else if (member == "isSigned") reader.read(pcmAudioParameters.isSigned);
+        else if (member == "bits") reader.read(pcmAudioParameters.bits);
+        else readJsonOtherMember(reader, member, pcmAudioParameters.otherMembers);
+    }
+
+    return !isEmpty;
+}
+
+// Read an array of integers
+static void readJsonArray(JsonReader &reader, QVector<qint32> &values)
+{
+    values.clear();
+    reader.beginArray();
+    while (reader.readElement()) {
+        qint32 value;
+        reader.read(value);
+        values.append(value);
+    }
+}
+
+// Read one element of the fields array
+void LdDecodeMetaData::readJsonField(JsonReader &reader, Field &field)
+{
+    QByteArray member, subMember;
+
+    reader.beginObject();
+    while (reader.readMember(member)) {
+        // Primary field values
+        if (member == "seqNo") reader.read(field.seqNo);
+        else if (member == "isFirstField") reader.read(field.isFirstField);
+        else if (member == "syncConf") reader.read(field.syncConf);
+        else if (member == "medianBurstIRE") reader.read(field.medianBurstIRE);
+        else if (member == "fieldPhaseID") reader.read(field.fieldPhaseID);
+        else if (member == "audioSamples") reader.read(field.audioSamples);
+        else if (member == "diskLoc") reader.read(field.diskLoc);
+        else if (member == "decodeFaults") reader.read(field.decodeFaults);
+        else if (member == "pad") reader.read(field.pad);
+
+        // VITS metrics values
+        else if (member == "vitsMetrics" && loadedFieldSections.testFlag(VitsMetricsSection)) {
+            reader.beginObject();
+            while (reader.readMember(subMember)) {
+                field.vitsMetrics.inUse = true;
+                if (subMember == "wSNR") reader.read(field.vitsMetrics.wSNR);
+                else if (subMember == "bPSNR") reader.read(field.vitsMetrics.bPSNR);
+                else readJsonOtherMember(reader, subMember, field.vitsMetrics.otherMembers);
+            }
+        }
+
+        // VBI values
+        else if (member == "vbi" && loadedFieldSections.testFlag(VbiSection)) {
+            reader.beginObject();
+            while (reader.readMember(subMember)) {
+                field.vbi.inUse = true;
+                if (subMember == "vbiData") readJsonArray(reader, field.vbi.vbiData);
+                else readJsonOtherMember(reader, subMember, field.vbi.otherMembers);
+            }
+        }
+
+        // NTSC values
+        else if (member == "ntsc" && loadedFieldSections.testFlag(NtscSection)) {
+            reader.beginObject();
+            while (reader.readMember(subMember)) {
+                field.ntsc.inUse = true;
+                if (subMember == "isFmCodeDataValid") reader.read(field.ntsc.isFmCodeDataValid);
+                else if (subMember == "fmCodeData") reader.read(field.ntsc.fmCodeData);
+                else if (subMember == "fieldFlag") reader.read(field.ntsc.fieldFlag);
+                else if (subMember == "whiteFlag") reader.read(field.ntsc.whiteFlag);
+                else if (subMember == "ccData0") reader.read(field.ntsc.ccData0);
+                else if (subMember == "ccData1") reader.read(field.ntsc.ccData1);
+                else readJsonOtherMember(reader, subMember, field.ntsc.otherMembers);
+            }
+        }
+
+        // dropOuts values
+        else if (member == "dropOuts" && loadedFieldSections.testFlag(DropOutsSection)) {
+            reader.beginObject();
+            while (reader.readMember(subMember)) {
+                if (subMember == "startx") readJsonArray(reader, field.dropOuts.startx);
+                else if (subMember == "endx") readJsonArray(reader, field.dropOuts.endx);
+                else if (subMember == "fieldLine") readJsonArray(reader, field.dropOuts.fieldLine);
+                else readJsonOtherMember(reader, subMember, field.dropOuts.otherMembers);
+            }
+        }
+
+        // Sections that aren't being loaded
+        else if (member == "vitsMetrics" || member == "vbi" || member == "ntsc" || member == "dropOuts") reader.discard();
+
+        // Other members
+        else readJsonOtherMember(reader, member, field.otherMembers);
+    }
+
+    // The VBI data is always sized to prevent assert issues downstream
+    field.vbi.vbiData.resize(3);
+
+    // Ensure that all three drop-out arrays are the same size
+    qint32 startxSize = field.dropOuts.startx.size();
+    if (field.dropOuts.endx.size() != startxSize || field.dropOuts.fieldLine.size() != startxSize) {
+        qCritical("JSON file is invalid: Dropouts object is illegal");
+        field.dropOuts.endx.resize(startxSize);
+        field.dropOuts.fieldLine.resize(startxSize);
+    }
+}
+
+// Write the metadata structure to a JSON metadata file.  The JSON is
+// generated and written incrementally, field by field
+bool LdDecodeMetaData::writeJson(QString fileName)
+{
+    qDebug() << "LdDecodeMetaData::writeJson(): Writing JSON metadata to:" << fileName;
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical("Writing JSON metadata file failed: file cannot be opened");
+        return false;
+    }
+
+    JsonWriter writer(file);
+    writer.beginObject();
+
+    // Write the video parameters
+    if (hasVideoParameters) {
+        const VideoParameters &videoParameters = metaData.videoParameters;
+        writer.writeMember("videoParameters");
+        writer.beginObject();
+        writer.writeMember("numberOfSequentialFields", videoParameters.numberOfSequentialFields);
+        writer.writeMember("isSourcePal", videoParameters.isSourcePal);
+
+        writer.writeMember("colourBurstStart", videoParameters.colourBurstStart);
+        writer.writeMember("colourBurstEnd", videoParameters.colourBurstEnd);
+        writer.writeMember("activeVideoStart", videoParameters.activeVideoStart);
+        writer.writeMember("activeVideoEnd", videoParameters.activeVideoEnd);
+
+        writer.writeMember("white16bIre", videoParameters.white16bIre);
+        writer.writeMember("black16bIre", videoParameters.black16bIre);
+
+        writer.writeMember("fieldWidth", videoParameters.fieldWidth);
+        writer.writeMember("fieldHeight", videoParameters.fieldHeight);
+        writer.writeMember("sampleRate", videoParameters.sampleRate);
+        writer.writeMember("fsc", videoParameters.fsc);
+
+        writer.writeMember("isMapped", videoParameters.isMapped);
+        writer.writeRawMembers(videoParameters.otherMembers);
+        writer.endObject();
+    }
+
+    // Write the PCM audio parameters
+    if (hasPcmAudioParameters) {
+        const PcmAudioParameters &pcmAudioParameters = metaData.pcmAudioParameters;
+        writer.writeMember("pcmAudioParameters");
+        writer.beginObject();
+        writer.writeMember("sampleRate", pcmAudioParameters.sampleRate);
+        writer.writeMember("isLittleEndian", pcmAudioParameters.isLittleEndian);
+        writer.writeMember("isSigned", pcmAudioParameters.isSigned);
+        writer.writeMember("bits", pcmAudioParameters.bits);
+        writer.writeRawMembers(pcmAudioParameters.otherMembers);
+        writer.endObject();
+    }
+
+    // Write the fields
+    if (!metaData.fields.isEmpty()) {
+        writer.writeMember("fields");
+        writer.beginArray();
+        for (const Field &field : metaData.fields) writeJsonField(writer, field);
+        writer.endArray();
+    }
+
+    writer.writeRawMembers(metaData.otherMembers);
+    writer.endObject();
+
+    if (!writer.flush()) {
         qCritical("Writing JSON metadata file failed!");
         return false;
     }
@@ -62,6 +391,669 @@ bool LdDecodeMetaData::write(QString fileName)
     return true;
 }
 
+// Write an array of integers
+static void writeJsonArray(JsonWriter &writer, const char *name, const QVector<qint32> &values, qint32 size)
+{
+    writer.writeMember(name);
+    writer.beginArray();
+    for (qint32 i = 0; i < size; i++) writer.write(values.value(i));
+    writer.endArray();
+}
+
+// Write one element of the fields array
+void LdDecodeMetaData::writeJsonField(JsonWriter &writer, const Field &field)
+{
+    writer.beginObject();
+
+    writer.writeMember("seqNo", field.seqNo);
+    writer.writeMember("isFirstField", field.isFirstField);
+    writer.writeMember("syncConf", field.syncConf);
+    writer.writeMember("medianBurstIRE", field.medianBurstIRE);
+    writer.writeMember("fieldPhaseID", field.fieldPhaseID);
+    writer.writeMember("audioSamples", field.audioSamples);
+    if (field.diskLoc != -1) writer.writeMember("diskLoc", field.diskLoc);
+    if (field.decodeFaults != -1) writer.writeMember("decodeFaults", field.decodeFaults);
+
+    // Write the VITS metrics data if in use
+    if (field.vitsMetrics.inUse) {
+        writer.writeMember("vitsMetrics");
+        writer.beginObject();
+        writer.writeMember("wSNR", field.vitsMetrics.wSNR);
+        writer.writeMember("bPSNR", field.vitsMetrics.bPSNR);
+        writer.writeRawMembers(field.vitsMetrics.otherMembers);
+        writer.endObject();
+    }
+
+    // Write the VBI data if in use
+    if (field.vbi.inUse) {
+        writer.writeMember("vbi");
+        writer.beginObject();
+        writeJsonArray(writer, "vbiData", field.vbi.vbiData, 3);
+        writer.writeRawMembers(field.vbi.otherMembers);
+        writer.endObject();
+    }
+
+    // Write the NTSC specific record if in use
+    if (field.ntsc.inUse) {
+        writer.writeMember("ntsc");
+        writer.beginObject();
+        writer.writeMember("isFmCodeDataValid", field.ntsc.isFmCodeDataValid);
+        writer.writeMember("fmCodeData", field.ntsc.fmCodeData);
+        writer.writeMember("fieldFlag", field.ntsc.fieldFlag);
+        writer.writeMember("whiteFlag", field.ntsc.whiteFlag);
+        writer.writeMember("ccData0", field.ntsc.ccData0);
+        writer.writeMember("ccData1", field.ntsc.ccData1);
+        writer.writeRawMembers(field.ntsc.otherMembers);
+        writer.endObject();
+    }
+
+    // Write the drop-out records
+    qint32 numberOfDropOuts = field.dropOuts.startx.size();
+    if (numberOfDropOuts > 0 || !field.dropOuts.otherMembers.isEmpty()) {
+        writer.writeMember("dropOuts");
+        writer.beginObject();
+        writeJsonArray(writer, "startx", field.dropOuts.startx, numberOfDropOuts);
+        writeJsonArray(writer, "endx", field.dropOuts.endx, numberOfDropOuts);
+        writeJsonArray(writer, "fieldLine", field.dropOuts.fieldLine, numberOfDropOuts);
+        writer.writeRawMembers(field.dropOuts.otherMembers);
+        writer.endObject();
+    }
+
+    // Padding flag
+    writer.writeMember("pad", field.pad);
+
+    writer.writeRawMembers(field.otherMembers);
+    writer.endObject();
+}
+
+// The binary format holds exactly the same information as the JSON format
+// (so files can be converted between them losslessly), but can be read
+// without parsing.  All values are little-endian:
+//
+//   Header:    char[8] magic "LDMETA03", quint32 number of fields, quint32
+//              flags (1 = videoParameters present, 2 = pcmAudioParameters
+//              present), 13 x qint32 videoParameters, 4 x qint32
+//              pcmAudioParameters, then the otherMembers of the metadata,
+//              videoParameters and pcmAudioParameters
+//   Fields:    one array per field member (struct-of-arrays), each with an
+//              entry for every field.  Boolean members are packed into a
+//              quint16 flags array, and the three VBI lines are stored as
+//              three arrays
+//   Other:     quint32 number of fields with otherMembers, then for each of
+//              them (in order) the quint32 field index followed by the
+//              otherMembers of the field, vitsMetrics, vbi, ntsc and dropOuts
+//   Drop-outs: a quint32 index array giving the first drop-out of each field
+//              (with an extra entry for the end of the last field), followed
+//              by the startx, endx and fieldLine arrays for all drop-outs
+//
+// otherMembers are stored as QDataStream QByteArrays (a quint32 length
+// followed by the JSON text).
+static const char BINARY_MAGIC[8] = {'L', 'D', 'M', 'E', 'T', 'A', '0', '3'};
+
+// Header flags
+static constexpr quint32 BINARY_HAS_VIDEO_PARAMETERS = 1;
+static constexpr quint32 BINARY_HAS_PCM_AUDIO_PARAMETERS = 2;
+
+// Field flags
+static constexpr quint16 BINARY_IS_FIRST_FIELD = 1;
+static constexpr quint16 BINARY_PAD = 2;
+static constexpr quint16 BINARY_VITS_IN_USE = 4;
+static constexpr quint16 BINARY_VBI_IN_USE = 8;
+static constexpr quint16 BINARY_NTSC_IN_USE = 16;
+static constexpr quint16 BINARY_NTSC_FM_CODE_VALID = 32;
+static constexpr quint16 BINARY_NTSC_FIELD_FLAG = 64;
+static constexpr quint16 BINARY_NTSC_WHITE_FLAG = 128;
+
+// Minimum number of bytes used by each field (used to check the header is sane)
+static constexpr qint64 BINARY_MIN_FIELD_SIZE = 2 + (12 * 4) + (4 * 8);
+
+// Returns true if the given file is in the binary metadata format
+bool LdDecodeMetaData::isBinaryFile(QString fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    return file.read(sizeof(BINARY_MAGIC)) == QByteArray::fromRawData(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+}
+
+// Read a binary metadata file into the metadata structure
+bool LdDecodeMetaData::readBinary(QString fileName)
+{
+    qDebug() << "LdDecodeMetaData::readBinary(): Loading binary metadata file" << fileName;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "Opening binary metadata file failed:" << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    // Read the header
+    char magic[sizeof(BINARY_MAGIC)];
+    if (stream.readRawData(magic, sizeof(magic)) != static_cast<int>(sizeof(magic)) || memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0) {
+        qCritical("Binary metadata file is invalid: incorrect header");
+        return false;
+    }
+
+    quint32 numberOfFields, flags;
+    stream >> numberOfFields >> flags;
+    if (static_cast<qint64>(numberOfFields) * BINARY_MIN_FIELD_SIZE > file.size()) {
+        qCritical("Binary metadata file is invalid: too many fields for the size of the file");
+        return false;
+    }
+
+    MetaData newMetaData;
+    VideoParameters &videoParameters = newMetaData.videoParameters;
+    qint32 isSourcePal, isMapped;
+    stream >> videoParameters.numberOfSequentialFields >> isSourcePal
+           >> videoParameters.colourBurstStart >> videoParameters.colourBurstEnd
+           >> videoParameters.activeVideoStart >> videoParameters.activeVideoEnd
+           >> videoParameters.white16bIre >> videoParameters.black16bIre
+           >> videoParameters.fieldWidth >> videoParameters.fieldHeight
+           >> videoParameters.sampleRate >> videoParameters.fsc >> isMapped;
+    videoParameters.isSourcePal = isSourcePal != 0;
+    videoParameters.isMapped = isMapped != 0;
+
+    PcmAudioParameters &pcmAudioParameters = newMetaData.pcmAudioParameters;
+    qint32 isLittleEndian, isSigned;
+    stream >> pcmAudioParameters.sampleRate >> isLittleEndian >> isSigned >> pcmAudioParameters.bits;
+    pcmAudioParameters.isLittleEndian = isLittleEndian != 0;
+    pcmAudioParameters.isSigned = isSigned != 0;
+
+    stream >> newMetaData.otherMembers >> videoParameters.otherMembers >> pcmAudioParameters.otherMembers;
+
+    // Read the per-field arrays
+    QVector<Field> &fields = newMetaData.fields;
+    fields.resize(static_cast<qint32>(numberOfFields));
+
+    // Arrays for sections that aren't being loaded are skipped over
+    const bool loadVitsMetrics = loadedFieldSections.testFlag(VitsMetricsSection);
+    const bool loadVbi = loadedFieldSections.testFlag(VbiSection);
+    const bool loadNtsc = loadedFieldSections.testFlag(NtscSection);
+    auto skipArray = [&](qint32 bytesPerField) {
+        stream.skipRawData(bytesPerField * fields.size());
+    };
+
+    for (Field &field : fields) stream >> field.seqNo;
+    for (Field &field : fields) {
+        quint16 fieldFlags;
+        stream >> fieldFlags;
+        field.isFirstField = (fieldFlags & BINARY_IS_FIRST_FIELD) != 0;
+        field.pad = (fieldFlags & BINARY_PAD) != 0;
+        field.vitsMetrics.inUse = loadVitsMetrics && (fieldFlags & BINARY_VITS_IN_USE) != 0;
+        field.vbi.inUse = loadVbi && (fieldFlags & BINARY_VBI_IN_USE) != 0;
+        field.ntsc.inUse = loadNtsc && (fieldFlags & BINARY_NTSC_IN_USE) != 0;
+        field.ntsc.isFmCodeDataValid = loadNtsc && (fieldFlags & BINARY_NTSC_FM_CODE_VALID) != 0;
+        field.ntsc.fieldFlag = loadNtsc && (fieldFlags & BINARY_NTSC_FIELD_FLAG) != 0;
+        field.ntsc.whiteFlag = loadNtsc && (fieldFlags & BINARY_NTSC_WHITE_FLAG) != 0;
+    }
+    for (Field &field : fields) stream >> field.syncConf;
+    for (Field &field : fields) stream >> field.medianBurstIRE;
+    for (Field &field : fields) stream >> field.fieldPhaseID;
+    for (Field &field : fields) stream >> field.audioSamples;
+    for (Field &field : fields) stream >> field.diskLoc;
+    for (Field &field : fields) stream >> field.decodeFaults;
+    if (loadVitsMetrics) {
+        for (Field &field : fields) stream >> field.vitsMetrics.wSNR;
+        for (Field &field : fields) stream >> field.vitsMetrics.bPSNR;
+    } else {
+        skipArray(2 * 8);
+    }
+    for (Field &field : fields) field.vbi.vbiData.resize(3);
+    if (loadVbi) {
+        for (qint32 line = 0; line < 3; line++) {
+            for (Field &field : fields) stream >> field.vbi.vbiData[line];
+        }
+    } else {
+        skipArray(3 * 4);
+    }
+    if (loadNtsc) {
+        for (Field &field : fields) stream >> field.ntsc.fmCodeData;
+        for (Field &field : fields) stream >> field.ntsc.ccData0;
+        for (Field &field : fields) stream >> field.ntsc.ccData1;
+    } else {
+        skipArray(3 * 4);
+    }
+
+    // Read the other members of the fields that have them.  Those of sections
+    // that aren't being loaded are dropped
+    const bool loadDropOuts = loadedFieldSections.testFlag(DropOutsSection);
+    quint32 numberOfOtherFields;
+    stream >> numberOfOtherFields;
+    qint64 previousIndex = -1;
+    for (quint32 i = 0; i < numberOfOtherFields && stream.status() == QDataStream::Ok; i++) {
+        quint32 index;
+        stream >> index;
+        if (static_cast<qint64>(index) <= previousIndex || index >= numberOfFields) {
+            qCritical("Binary metadata file is invalid: other members index is out of order or range");
+            return false;
+        }
+        previousIndex = index;
+
+        Field &field = fields[static_cast<qint32>(index)];
+        stream >> field.otherMembers >> field.vitsMetrics.otherMembers >> field.vbi.otherMembers
+               >> field.ntsc.otherMembers >> field.dropOuts.otherMembers;
+        if (!loadVitsMetrics) field.vitsMetrics.otherMembers.clear();
+        if (!loadVbi) field.vbi.otherMembers.clear();
+        if (!loadNtsc) field.ntsc.otherMembers.clear();
+        if (!loadDropOuts) field.dropOuts.otherMembers.clear();
+    }
+
+    // The drop-outs are stored last, so they don't need to be read at all if they aren't being loaded
+    if (loadDropOuts) {
+        // Read the drop-out index, and check it's in order
+        QVector<quint32> dropOutIndex(fields.size() + 1);
+        for (quint32 &index : dropOutIndex) stream >> index;
+        for (qint32 i = 0; i < fields.size(); i++) {
+            if (dropOutIndex[i] > dropOutIndex[i + 1]) {
+                qCritical("Binary metadata file is invalid: drop-out index is out of order");
+                return false;
+            }
+        }
+        if (static_cast<qint64>(dropOutIndex.last()) * 12 > file.size()) {
+            qCritical("Binary metadata file is invalid: too many drop-outs for the size of the file");
+            return false;
+        }
+
+        // Read the drop-outs
+        for (qint32 i = 0; i < fields.size(); i++) {
+            const qint32 numberOfDropOuts = static_cast<qint32>(dropOutIndex[i + 1] - dropOutIndex[i]);
+            fields[i].dropOuts.startx.resize(numberOfDropOuts);
+            fields[i].dropOuts.endx.resize(numberOfDropOuts);
+            fields[i].dropOuts.fieldLine.resize(numberOfDropOuts);
+        }
+        for (Field &field : fields) {
+            for (qint32 &startx : field.dropOuts.startx) stream >> startx;
+        }
+        for (Field &field : fields) {
+            for (qint32 &endx : field.dropOuts.endx) stream >> endx;
+        }
+        for (Field &field : fields) {
+            for (qint32 &fieldLine : field.dropOuts.fieldLine) stream >> fieldLine;
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qCritical("Binary metadata file is invalid: file is truncated");
+        return false;
+    }
+
+    metaData = newMetaData;
+    hasVideoParameters = (flags & BINARY_HAS_VIDEO_PARAMETERS) != 0;
+    hasPcmAudioParameters = (flags & BINARY_HAS_PCM_AUDIO_PARAMETERS) != 0;
+
+    return true;
+}
+
+// Write the metadata structure to a binary metadata file.  This is never
+// done implicitly; read() will accept the file in place of the JSON
+bool LdDecodeMetaData::writeBinary(QString fileName)
+{
+    if (!areAllFieldSectionsLoaded("LdDecodeMetaData::writeBinary():")) return false;
+
+    qDebug() << "LdDecodeMetaData::writeBinary(): Writing binary metadata to:" << fileName;
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "LdDecodeMetaData::writeBinary(): Could not open file -" << file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    // Write the header
+    const QVector<Field> &fields = metaData.fields;
+    quint32 flags = 0;
+    if (hasVideoParameters) flags |= BINARY_HAS_VIDEO_PARAMETERS;
+    if (hasPcmAudioParameters) flags |= BINARY_HAS_PCM_AUDIO_PARAMETERS;
+    stream.writeRawData(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    stream << static_cast<quint32>(fields.size()) << flags;
+
+    const VideoParameters &videoParameters = metaData.videoParameters;
+    stream << videoParameters.numberOfSequentialFields << static_cast<qint32>(videoParameters.isSourcePal)
+           << videoParameters.colourBurstStart << videoParameters.colourBurstEnd
+           << videoParameters.activeVideoStart << videoParameters.activeVideoEnd
+           << videoParameters.white16bIre << videoParameters.black16bIre
+           << videoParameters.fieldWidth << videoParameters.fieldHeight
+           << videoParameters.sampleRate << videoParameters.fsc << static_cast<qint32>(videoParameters.isMapped);
+
+    const PcmAudioParameters &pcmAudioParameters = metaData.pcmAudioParameters;
+    stream << pcmAudioParameters.sampleRate << static_cast<qint32>(pcmAudioParameters.isLittleEndian)
+           << static_cast<qint32>(pcmAudioParameters.isSigned) << pcmAudioParameters.bits;
+
+    stream << metaData.otherMembers << videoParameters.otherMembers << pcmAudioParameters.otherMembers;
+
+    // Write the per-field arrays
+    for (const Field &field : fields) stream << field.seqNo;
+    for (const Field &field : fields) {
+        quint16 fieldFlags = 0;
+        if (field.isFirstField) fieldFlags |= BINARY_IS_FIRST_FIELD;
+        if (field.pad) fieldFlags |= BINARY_PAD;
+        if (field.vitsMetrics.inUse) fieldFlags |= BINARY_VITS_IN_USE;
+        if (field.vbi.inUse) fieldFlags |= BINARY_VBI_IN_USE;
+        if (field.ntsc.inUse) fieldFlags |= BINARY_NTSC_IN_USE;
+        if (field.ntsc.isFmCodeDataValid) fieldFlags |= BINARY_NTSC_FM_CODE_VALID;
+        if (field.ntsc.fieldFlag) fieldFlags |= BINARY_NTSC_FIELD_FLAG;
+        if (field.ntsc.whiteFlag) fieldFlags |= BINARY_NTSC_WHITE_FLAG;
+        stream << fieldFlags;
+    }
+    for (const Field &field : fields) stream << field.syncConf;
+    for (const Field &field : fields) stream << field.medianBurstIRE;
+    for (const Field &field : fields) stream << field.fieldPhaseID;
+    for (const Field &field : fields) stream << field.audioSamples;
+    for (const Field &field : fields) stream << field.diskLoc;
+    for (const Field &field : fields) stream << field.decodeFaults;
+    for (const Field &field : fields) stream << field.vitsMetrics.wSNR;
+    for (const Field &field : fields) stream << field.vitsMetrics.bPSNR;
+    for (qint32 line = 0; line < 3; line++) {
+        for (const Field &field : fields) stream << field.vbi.vbiData.value(line);
+    }
+    for (const Field &field : fields) stream << field.ntsc.fmCodeData;
+    for (const Field &field : fields) stream << field.ntsc.ccData0;
+    for (const Field &field : fields) stream << field.ntsc.ccData1;
+
+    // Write the other members of the fields that have them
+    auto hasOtherMembers = [](const Field &field) {
+        return !field.otherMembers.isEmpty() || !field.vitsMetrics.otherMembers.isEmpty() || !field.vbi.otherMembers.isEmpty()
+               || !field.ntsc.otherMembers.isEmpty() || !field.dropOuts.otherMembers.isEmpty();
+    };
+    stream << static_cast<quint32>(std::count_if(fields.begin(), fields.end(), hasOtherMembers));
+    for (qint32 i = 0; i < fields.size(); i++) {
+        const Field &field = fields[i];
+        if (!hasOtherMembers(field)) continue;
+
+        stream << static_cast<quint32>(i) << field.otherMembers << field.vitsMetrics.otherMembers << field.vbi.otherMembers
+               << field.ntsc.otherMembers << field.dropOuts.otherMembers;
+    }
+
+    // Write the drop-out index and the drop-outs
+    quint32 dropOutIndex = 0;
+    for (const Field &field : fields) {
+        stream << dropOutIndex;
+        dropOutIndex += static_cast<quint32>(field.dropOuts.startx.size());
+    }
+    stream << dropOutIndex;
+    for (const Field &field : fields) {
+        for (qint32 i = 0; i < field.dropOuts.startx.size(); i++) stream << field.dropOuts.startx[i];
+    }
+    for (const Field &field : fields) {
+        for (qint32 i = 0; i < field.dropOuts.startx.size(); i++) stream << field.dropOuts.endx.value(i);
+    }
+    for (const Field &field : fields) {
+        for (qint32 i = 0; i < field.dropOuts.startx.size(); i++) stream << field.dropOuts.fieldLine.value(i);
+    }
+
+    if (stream.status() != QDataStream::Ok) return false;
+    file.close();
+    return file.error() == QFileDevice::NoError;
+}
+
+// The journal is an append-only log of updated fields, so the results of a
+// long run are not lost if it is interrupted before the metadata file is
+// written.  All values are little-endian:
+//
+//   Header:    char[8] magic "LDJRNL03", qint64 size and qint64 modification
+//              time (in ms since the epoch) of the metadata file the journal
+//              applies to, quint32 number of fields in the metadata when the
+//              journal was created
+//   Records:   quint32 payload size, quint16 CRC-16 of the payload (see
+//              qChecksum), then the payload: qint32 sequential field number
+//              followed by all the field's values (with the same flags as the
+//              binary format), ending with its otherMembers.  If the same
+//              field appears more than once, the last record wins
+//
+// A record that was only partly written (or is corrupt) marks the end of the
+// journal; it is discarded when the journal is next opened
+static const char JOURNAL_MAGIC[8] = {'L', 'D', 'J', 'R', 'N', 'L', '0', '3'};
+static constexpr qint64 JOURNAL_HEADER_SIZE = sizeof(JOURNAL_MAGIC) + 8 + 8 + 4;
+static constexpr qint64 JOURNAL_RECORD_HEADER_SIZE = 4 + 2;
+
+// Get the filename of the journal for a metadata file
+QString LdDecodeMetaData::getJournalFileName(QString fileName)
+{
+    return fileName + ".journal";
+}
+
+// Open a journal of field updates to the metadata read from sourceFileName.
+// If the journal already exists (from an interrupted run), the fields it
+// contains are applied to the metadata first and can be found with
+// isFieldJournalled(); this fails if the journal was started from a different
+// version of sourceFileName.  Once open, fields changed by the update methods
+// are appended to the journal by flushJournal().
+//
+// The caller must serialise flushJournal() with the update methods
+bool LdDecodeMetaData::openJournal(QString fileName, QString sourceFileName)
+{
+    if (!areAllFieldSectionsLoaded("LdDecodeMetaData::openJournal():")) return false;
+
+    closeJournal();
+    journalledFields.fill(false, getNumberOfFields());
+
+    const QFileInfo sourceFileInfo(sourceFileName);
+    const qint64 sourceSize = sourceFileInfo.size();
+    const qint64 sourceModified = sourceFileInfo.lastModified().toMSecsSinceEpoch();
+
+    journalFile.setFileName(fileName);
+    if (!journalFile.open(QIODevice::ReadWrite)) {
+        qCritical() << "Could not open the metadata journal" << fileName << "-" << journalFile.errorString();
+        return false;
+    }
+
+    if (journalFile.size() == 0) {
+        // New journal, so write the header
+        QByteArray header;
+        QDataStream stream(&header, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.writeRawData(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        stream << sourceSize << sourceModified << static_cast<quint32>(getNumberOfFields());
+
+        if (journalFile.write(header) != header.size() || !journalFile.flush()) {
+            qCritical() << "Could not write the metadata journal" << fileName << "-" << journalFile.errorString();
+            journalFile.close();
+            return false;
+        }
+    } else if (!replayJournal(sourceSize, sourceModified)) {
+        journalFile.close();
+        return false;
+    }
+
+    return true;
+}
+
+// Append the fields updated since the last flush to the journal
+bool LdDecodeMetaData::flushJournal()
+{
+    if (!journalFile.isOpen() || journalPendingFields.isEmpty()) return true;
+
+    std::sort(journalPendingFields.begin(), journalPendingFields.end());
+    journalPendingFields.erase(std::unique(journalPendingFields.begin(), journalPendingFields.end()),
+                               journalPendingFields.end());
+
+    QByteArray records;
+    QDataStream recordStream(&records, QIODevice::WriteOnly);
+    recordStream.setByteOrder(QDataStream::LittleEndian);
+
+    for (qint32 fieldNumber : journalPendingFields) {
+        const Field &field = metaData.fields[fieldNumber];
+
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+        quint16 fieldFlags = 0;
+        if (field.isFirstField) fieldFlags |= BINARY_IS_FIRST_FIELD;
+        if (field.pad) fieldFlags |= BINARY_PAD;
+        if (field.vitsMetrics.inUse) fieldFlags |= BINARY_VITS_IN_USE;
+        if (field.vbi.inUse) fieldFlags |= BINARY_VBI_IN_USE;
+        if (field.ntsc.inUse) fieldFlags |= BINARY_NTSC_IN_USE;
+        if (field.ntsc.isFmCodeDataValid) fieldFlags |= BINARY_NTSC_FM_CODE_VALID;
+        if (field.ntsc.fieldFlag) fieldFlags |= BINARY_NTSC_FIELD_FLAG;
+        if (field.ntsc.whiteFlag) fieldFlags |= BINARY_NTSC_WHITE_FLAG;
+
+        stream << static_cast<qint32>(fieldNumber + 1) << fieldFlags << field.seqNo << field.syncConf
+               << field.medianBurstIRE << field.fieldPhaseID << field.audioSamples
+               << field.diskLoc << field.decodeFaults
+               << field.vitsMetrics.wSNR << field.vitsMetrics.bPSNR
+               << field.vbi.vbiData.value(0) << field.vbi.vbiData.value(1) << field.vbi.vbiData.value(2)
+               << field.ntsc.fmCodeData << field.ntsc.ccData0 << field.ntsc.ccData1;
+
+        const DropOuts &dropOuts = field.dropOuts;
+        stream << static_cast<quint32>(dropOuts.startx.size());
+        for (qint32 i = 0; i < dropOuts.startx.size(); i++) {
+            stream << dropOuts.startx[i] << dropOuts.endx.value(i) << dropOuts.fieldLine.value(i);
+        }
+
+        stream << field.otherMembers << field.vitsMetrics.otherMembers << field.vbi.otherMembers
+               << field.ntsc.otherMembers << dropOuts.otherMembers;
+
+        recordStream << static_cast<quint32>(payload.size())
+                     << static_cast<quint16>(qChecksum(payload.constData(), static_cast<uint>(payload.size())));
+        recordStream.writeRawData(payload.constData(), payload.size());
+    }
+    journalPendingFields.clear();
+
+    if (journalFile.write(records) != records.size() || !journalFile.flush()) {
+        qCritical() << "Could not write to the metadata journal -" << journalFile.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+// Flush and close the journal (leaving the journal file in place)
+void LdDecodeMetaData::closeJournal()
+{
+    if (!journalFile.isOpen()) return;
+
+    flushJournal();
+    journalFile.close();
+}
+
+// Close and delete the journal.  This should be done once the metadata has
+// been written successfully, as the journal is then no longer needed
+bool LdDecodeMetaData::removeJournal()
+{
+    journalPendingFields.clear();
+    if (journalFile.fileName().isEmpty()) return true;
+
+    journalFile.close();
+    return journalFile.remove();
+}
+
+// Returns true if the field was updated by the interrupted run the journal
+// was opened from (so it doesn't need processing again)
+bool LdDecodeMetaData::isFieldJournalled(qint32 sequentialFieldNumber) const
+{
+    return journalledFields.value(sequentialFieldNumber - 1, false);
+}
+
+// Apply the records of an existing journal to the metadata, if it was started
+// from a metadata file of the given size and modification time
+bool LdDecodeMetaData::replayJournal(qint64 sourceSize, qint64 sourceModified)
+{
+    QByteArray journal = journalFile.readAll();
+    QDataStream stream(journal);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    // Check the header
+    char magic[sizeof(JOURNAL_MAGIC)];
+    qint64 journalSourceSize = 0, journalSourceModified = 0;
+    quint32 numberOfFields = 0;
+    if (stream.readRawData(magic, sizeof(magic)) != static_cast<int>(sizeof(magic)) || memcmp(magic, JOURNAL_MAGIC, sizeof(magic)) != 0) {
+        qCritical() << journalFile.fileName() << "is not a metadata journal";
+        return false;
+    }
+    stream >> journalSourceSize >> journalSourceModified >> numberOfFields;
+    if (stream.status() != QDataStream::Ok || journalSourceSize != sourceSize || journalSourceModified != sourceModified
+            || static_cast<qint32>(numberOfFields) != getNumberOfFields()) {
+        qCritical() << "The metadata journal" << journalFile.fileName() << "was not started from this version of the metadata";
+        return false;
+    }
+
+    // Apply the records
+    qint64 validSize = JOURNAL_HEADER_SIZE;
+    qint32 numberOfRecords = 0;
+    while (journal.size() - validSize >= JOURNAL_RECORD_HEADER_SIZE) {
+        quint32 payloadSize;
+        quint16 checksum;
+        stream >> payloadSize >> checksum;
+        if (payloadSize > static_cast<quint64>(journal.size() - validSize - JOURNAL_RECORD_HEADER_SIZE)) break;
+
+        const char *payloadData = journal.constData() + validSize + JOURNAL_RECORD_HEADER_SIZE;
+        if (qChecksum(payloadData, payloadSize) != checksum) break;
+
+        const QByteArray payload = QByteArray::fromRawData(payloadData, static_cast<int>(payloadSize));
+        QDataStream payloadStream(payload);
+        payloadStream.setByteOrder(QDataStream::LittleEndian);
+        payloadStream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+        qint32 sequentialFieldNumber;
+        quint16 fieldFlags;
+        Field field;
+        field.vbi.vbiData.resize(3);
+        payloadStream >> sequentialFieldNumber >> fieldFlags >> field.seqNo >> field.syncConf
+                      >> field.medianBurstIRE >> field.fieldPhaseID >> field.audioSamples
+                      >> field.diskLoc >> field.decodeFaults
+                      >> field.vitsMetrics.wSNR >> field.vitsMetrics.bPSNR
+                      >> field.vbi.vbiData[0] >> field.vbi.vbiData[1] >> field.vbi.vbiData[2]
+                      >> field.ntsc.fmCodeData >> field.ntsc.ccData0 >> field.ntsc.ccData1;
+
+        quint32 numberOfDropOuts;
+        payloadStream >> numberOfDropOuts;
+        if (payloadStream.status() != QDataStream::Ok || numberOfDropOuts > payloadSize) break;
+        field.dropOuts.startx.resize(static_cast<qint32>(numberOfDropOuts));
+        field.dropOuts.endx.resize(static_cast<qint32>(numberOfDropOuts));
+        field.dropOuts.fieldLine.resize(static_cast<qint32>(numberOfDropOuts));
+        for (qint32 i = 0; i < static_cast<qint32>(numberOfDropOuts); i++) {
+            payloadStream >> field.dropOuts.startx[i] >> field.dropOuts.endx[i] >> field.dropOuts.fieldLine[i];
+        }
+
+        payloadStream >> field.otherMembers >> field.vitsMetrics.otherMembers >> field.vbi.otherMembers
+                      >> field.ntsc.otherMembers >> field.dropOuts.otherMembers;
+
+        if (payloadStream.status() != QDataStream::Ok
+                || sequentialFieldNumber < 1 || sequentialFieldNumber > getNumberOfFields()) break;
+
+        field.isFirstField = (fieldFlags & BINARY_IS_FIRST_FIELD) != 0;
+        field.pad = (fieldFlags & BINARY_PAD) != 0;
+        field.vitsMetrics.inUse = (fieldFlags & BINARY_VITS_IN_USE) != 0;
+        field.vbi.inUse = (fieldFlags & BINARY_VBI_IN_USE) != 0;
+        field.ntsc.inUse = (fieldFlags & BINARY_NTSC_IN_USE) != 0;
+        field.ntsc.isFmCodeDataValid = (fieldFlags & BINARY_NTSC_FM_CODE_VALID) != 0;
+        field.ntsc.fieldFlag = (fieldFlags & BINARY_NTSC_FIELD_FLAG) != 0;
+        field.ntsc.whiteFlag = (fieldFlags & BINARY_NTSC_WHITE_FLAG) != 0;
+
+        if (metaData.fields[sequentialFieldNumber - 1].isFirstField != field.isFirstField) isFrameIndexValid = false;
+        metaData.fields[sequentialFieldNumber - 1] = field;
+        journalledFields[sequentialFieldNumber - 1] = true;
+
+        numberOfRecords++;
+        validSize += JOURNAL_RECORD_HEADER_SIZE + payloadSize;
+        stream.skipRawData(static_cast<int>(payloadSize));
+    }
+
+    // Discard anything after the last complete record, so new records follow on from it
+    if (validSize != journal.size()) {
+        qWarning() << "Discarding" << journal.size() - validSize << "bytes of incomplete records from the end of the metadata journal";
+        if (!journalFile.resize(validSize)) {
+            qCritical() << "Could not truncate the metadata journal -" << journalFile.errorString();
+            return false;
+        }
+    }
+    journalFile.seek(validSize);
+
+    // Rebuild the frame index now, rather than on a (possibly concurrent) lookup
+    if (!isFrameIndexValid) buildFrameIndex();
+
+    qInfo() << "Resuming from the metadata journal -" << numberOfRecords << "field updates applied";
+    return true;
+}
+
 // This method copies the VITS metadata structure into a CSV metadata file
 bool LdDecodeMetaData::writeVitsCsv(QString fileName)
 {
@@ -115,257 +1107,138 @@ QString LdDecodeMetaData::escapedString(QString unescapedString)
 }
 
 // This method returns the videoParameters metadata
-LdDecodeMetaData::VideoParameters LdDecodeMetaData::getVideoParameters()
+LdDecodeMetaData::VideoParameters LdDecodeMetaData::getVideoParameters() const
 {
-    VideoParameters videoParameters;
-
-    // Read the video paramters
-    if (json.size({"videoParameters"}) > 0) {
-        videoParameters.numberOfSequentialFields = json.value({"videoParameters", "numberOfSequentialFields"}).toInt();
-        videoParameters.isSourcePal = json.value({"videoParameters", "isSourcePal"}).toBool();
-
-        videoParameters.colourBurstStart = json.value({"videoParameters", "colourBurstStart"}).toInt();
-        videoParameters.colourBurstEnd = json.value({"videoParameters", "colourBurstEnd"}).toInt();
-        videoParameters.activeVideoStart = json.value({"videoParameters", "activeVideoStart"}).toInt();
-        videoParameters.activeVideoEnd = json.value({"videoParameters", "activeVideoEnd"}).toInt();
-
-        videoParameters.white16bIre = json.value({"videoParameters", "white16bIre"}).toInt();
-        videoParameters.black16bIre = json.value({"videoParameters", "black16bIre"}).toInt();
-
-        videoParameters.fieldWidth = json.value({"videoParameters", "fieldWidth"}).toInt();
-        videoParameters.fieldHeight = json.value({"videoParameters", "fieldHeight"}).toInt();
-        videoParameters.sampleRate = json.value({"videoParameters", "sampleRate"}).toInt();
-        videoParameters.fsc = json.value({"videoParameters", "fsc"}).toInt();
-
-        videoParameters.isMapped = json.value({"videoParameters", "isMapped"}).toBool();
-    } else {
+    if (!hasVideoParameters) {
         qCritical("JSON file invalid: videoParameters object is not defined");
-        return videoParameters;
     }
 
-    return videoParameters;
+    return metaData.videoParameters;
 }
 
 // This method sets the videoParameters metadata
 void LdDecodeMetaData::setVideoParameters (LdDecodeMetaData::VideoParameters _videoParameters)
 {
-    // Write the video parameters
-    json.setValue({"videoParameters", "numberOfSequentialFields"}, getNumberOfFields());
-    json.setValue({"videoParameters", "isSourcePal"}, _videoParameters.isSourcePal);
-
-    json.setValue({"videoParameters", "colourBurstStart"}, _videoParameters.colourBurstStart);
-    json.setValue({"videoParameters", "colourBurstEnd"}, _videoParameters.colourBurstEnd);
-    json.setValue({"videoParameters", "activeVideoStart"}, _videoParameters.activeVideoStart);
-    json.setValue({"videoParameters", "activeVideoEnd"}, _videoParameters.activeVideoEnd);
-
-    json.setValue({"videoParameters", "white16bIre"}, _videoParameters.white16bIre);
-    json.setValue({"videoParameters", "black16bIre"}, _videoParameters.black16bIre);
-
-    json.setValue({"videoParameters", "fieldWidth"}, _videoParameters.fieldWidth);
-    json.setValue({"videoParameters", "fieldHeight"}, _videoParameters.fieldHeight);
-    json.setValue({"videoParameters", "sampleRate"}, _videoParameters.sampleRate);
-    json.setValue({"videoParameters", "fsc"}, _videoParameters.fsc);
-
-    json.setValue({"videoParameters", "isMapped"}, _videoParameters.isMapped);
+    metaData.videoParameters = _videoParameters;
+    metaData.videoParameters.numberOfSequentialFields = getNumberOfFields();
+    hasVideoParameters = true;
 }
 
 // This method returns the pcmAudioParameters metadata
-LdDecodeMetaData::PcmAudioParameters LdDecodeMetaData::getPcmAudioParameters()
+LdDecodeMetaData::PcmAudioParameters LdDecodeMetaData::getPcmAudioParameters() const
 {
-    PcmAudioParameters pcmAudioParameters;
-
-    if (json.size({"pcmAudioParameters"}) > 0) {
-        // Read the PCM audio data
-        pcmAudioParameters.sampleRate = json.value({"pcmAudioParameters", "sampleRate"}).toInt();
-        pcmAudioParameters.isLittleEndian = json.value({"pcmAudioParameters", "isLittleEndian"}).toBool();
-        pcmAudioParameters.isSigned = json.value({"pcmAudioParameters", "isSigned"}).toBool();
-        pcmAudioParameters.bits = json.value({"pcmAudioParameters", "bits"}).toInt();
-    } else {
+    if (!hasPcmAudioParameters) {
         qCritical("JSON file invalid: pcmAudioParameters is not defined");
-        return pcmAudioParameters;
     }
 
-    return pcmAudioParameters;
+    return metaData.pcmAudioParameters;
 }
 
 // This method sets the pcmAudioParameters metadata
 void LdDecodeMetaData::setPcmAudioParameters(LdDecodeMetaData::PcmAudioParameters _pcmAudioParam)
 {
-    json.setValue({"pcmAudioParameters", "sampleRate"}, _pcmAudioParam.sampleRate);
-    json.setValue({"pcmAudioParameters", "isLittleEndian"}, _pcmAudioParam.isLittleEndian);
-    json.setValue({"pcmAudioParameters", "isSigned"}, _pcmAudioParam.isSigned);
-    json.setValue({"pcmAudioParameters", "bits"}, _pcmAudioParam.bits);
+    metaData.pcmAudioParameters = _pcmAudioParam;
+    hasPcmAudioParameters = true;
 }
 
 // This method gets the metadata for the specified sequential field number (indexed from 1 (not 0!))
-LdDecodeMetaData::Field LdDecodeMetaData::getField(qint32 sequentialFieldNumber)
+LdDecodeMetaData::Field LdDecodeMetaData::getField(qint32 sequentialFieldNumber) const
 {
-    Field field;
     qint32 fieldNumber = sequentialFieldNumber - 1;
 
     if (fieldNumber >= getNumberOfFields() || fieldNumber < 0) {
         qCritical() << "LdDecodeMetaData::getField(): Requested field number" << sequentialFieldNumber << "out of bounds!";
+        Field field;
+        field.vbi.vbiData.resize(3);
+        return field;
     }
 
-    // Primary field values
-    field.seqNo = json.value({"fields", fieldNumber, "seqNo"}).toInt();
-    field.isFirstField = json.value({"fields", fieldNumber, "isFirstField"}).toBool();
-    field.syncConf = json.value({"fields", fieldNumber, "syncConf"}).toInt();
-    field.medianBurstIRE = json.value({"fields", fieldNumber, "medianBurstIRE"}).toDouble();
-    field.fieldPhaseID = json.value({"fields", fieldNumber, "fieldPhaseID"}).toInt();
-    field.audioSamples = json.value({"fields", fieldNumber, "audioSamples"}).toInt();
-
-    // VITS metrics values
-    field.vitsMetrics = getFieldVitsMetrics(sequentialFieldNumber);
-
-    // VBI values
-    field.vbi = getFieldVbi(sequentialFieldNumber);
-
-    // NTSC values
-    field.ntsc = getFieldNtsc(sequentialFieldNumber);
-
-    // dropOuts values
-    field.dropOuts = getFieldDropOuts(sequentialFieldNumber);
-
-    // Padding flag
-    field.pad = json.value({"fields", fieldNumber, "pad"}).toBool();
-
-    return field;
+    return metaData.fields[fieldNumber];
 }
 
 // This method gets the VITS metrics metadata for the specified sequential field number
-LdDecodeMetaData::VitsMetrics LdDecodeMetaData::getFieldVitsMetrics(qint32 sequentialFieldNumber)
+LdDecodeMetaData::VitsMetrics LdDecodeMetaData::getFieldVitsMetrics(qint32 sequentialFieldNumber) const
 {
-    VitsMetrics vitsMetrics;
     qint32 fieldNumber = sequentialFieldNumber - 1;
 
     if (fieldNumber >= getNumberOfFields() || fieldNumber < 0) {
         qCritical() << "LdDecodeMetaData::getFieldVitsMetrics(): Requested field number" << sequentialFieldNumber << "out of bounds!";
+        return VitsMetrics();
     }
 
-    if (json.size({"fields", fieldNumber, "vitsMetrics"}) > 0) {
-        vitsMetrics.inUse = true;
-        vitsMetrics.wSNR = json.value({"fields", fieldNumber, "vitsMetrics", "wSNR"}).toReal();
-        vitsMetrics.bPSNR = json.value({"fields", fieldNumber, "vitsMetrics", "bPSNR"}).toReal();
-    } else {
-        // Mark VITS metrics as undefined
-        vitsMetrics.inUse = false;
-    }
-
-    return vitsMetrics;
+    return metaData.fields[fieldNumber].vitsMetrics;
 }
 
 // This method gets the VBI metadata for the specified sequential field number
-LdDecodeMetaData::Vbi LdDecodeMetaData::getFieldVbi(qint32 sequentialFieldNumber)
+LdDecodeMetaData::Vbi LdDecodeMetaData::getFieldVbi(qint32 sequentialFieldNumber) const
 {
-    Vbi vbi;
     qint32 fieldNumber = sequentialFieldNumber - 1;
 
     if (fieldNumber >= getNumberOfFields() || fieldNumber < 0) {
         qCritical() << "LdDecodeMetaData::getFieldVbi(): Requested field number" << sequentialFieldNumber << "out of bounds!";
-    }
-
-    if (json.size({"fields", fieldNumber, "vbi"}) > 0) {
-        // Mark VBI as in use
-        vbi.inUse = true;
-
-        vbi.vbiData.append(json.value({"fields", fieldNumber, "vbi", "vbiData", 0}).toInt()); // Line 16
-        vbi.vbiData.append(json.value({"fields", fieldNumber, "vbi", "vbiData", 1}).toInt()); // Line 17
-        vbi.vbiData.append(json.value({"fields", fieldNumber, "vbi", "vbiData", 2}).toInt()); // Line 18
-    } else {
-        // Mark VBI as undefined
-        vbi.inUse = false;
-
-        // Resize the VBI data fields to prevent assert issues downstream
+        Vbi vbi;
         vbi.vbiData.resize(3);
+        return vbi;
     }
 
-    return vbi;
+    return metaData.fields[fieldNumber].vbi;
 }
 
 // This method gets the NTSC metadata for the specified sequential field number
-LdDecodeMetaData::Ntsc LdDecodeMetaData::getFieldNtsc(qint32 sequentialFieldNumber)
+LdDecodeMetaData::Ntsc LdDecodeMetaData::getFieldNtsc(qint32 sequentialFieldNumber) const
 {
-    Ntsc ntsc;
     qint32 fieldNumber = sequentialFieldNumber - 1;
 
     if (fieldNumber >= getNumberOfFields() || fieldNumber < 0) {
         qCritical() << "LdDecodeMetaData::getFieldNtsc(): Requested field number" << sequentialFieldNumber << "out of bounds!";
+        return Ntsc();
     }
 
-    if (json.size({"fields", fieldNumber, "ntsc"}) > 0) {
-        // Mark as in use
-        ntsc.inUse = true;
-
-        ntsc.isFmCodeDataValid = json.value({"fields", fieldNumber, "ntsc", "isFmCodeDataValid"}).toBool();
-        ntsc.fmCodeData = json.value({"fields", fieldNumber, "ntsc", "fmCodeData"}).toInt();
-        ntsc.fieldFlag = json.value({"fields", fieldNumber, "ntsc", "fieldFlag"}).toBool();
-        ntsc.whiteFlag = json.value({"fields", fieldNumber, "ntsc", "whiteFlag"}).toBool();
-        ntsc.ccData0 = json.value({"fields", fieldNumber, "ntsc", "ccData0"}).toInt();
-        ntsc.ccData1 = json.value({"fields", fieldNumber, "ntsc", "ccData1"}).toInt();
-    } else {
-        // Mark ntscSpecific as undefined
-        ntsc.inUse = false;
-    }
-
-    return ntsc;
+    return metaData.fields[fieldNumber].ntsc;
 }
 
 // This method gets the drop-out metadata for the specified sequential field number
-LdDecodeMetaData::DropOuts LdDecodeMetaData::getFieldDropOuts(qint32 sequentialFieldNumber)
+LdDecodeMetaData::DropOuts LdDecodeMetaData::getFieldDropOuts(qint32 sequentialFieldNumber) const
 {
-    DropOuts dropOuts;
     qint32 fieldNumber = sequentialFieldNumber - 1;
 
     if (fieldNumber >= getNumberOfFields() || fieldNumber < 0) {
         qCritical() << "LdDecodeMetaData::getFieldDropOuts(): Requested field number" << sequentialFieldNumber << "out of bounds!";
+        return DropOuts();
     }
 
-    // Get the JSON array sizes
-    qint32 startxSize = json.size({"fields", fieldNumber, "dropOuts", "startx"});
-    qint32 endxSize = json.size({"fields", fieldNumber, "dropOuts", "endx"});
-    qint32 fieldLinesSize = json.size({"fields", fieldNumber, "dropOuts", "fieldLines"});
-
-    // Ensure that all three objects are the same size
-    if (startxSize != endxSize && startxSize != fieldLinesSize) {
-        qCritical("JSON file is invalid: Dropouts object is illegal");
-    }
-
-    if (startxSize > 0) {
-        dropOuts.startx.resize(startxSize);
-        dropOuts.endx.resize(startxSize);
-        dropOuts.fieldLine.resize(startxSize);
-
-        for (qint32 doCounter = 0; doCounter < startxSize; doCounter++) {
-            dropOuts.startx[doCounter] = json.value({"fields", fieldNumber, "dropOuts", "startx", doCounter}).toInt();
-            dropOuts.endx[doCounter] = json.value({"fields", fieldNumber, "dropOuts", "endx", doCounter}).toInt();
-            dropOuts.fieldLine[doCounter] = json.value({"fields", fieldNumber, "dropOuts", "fieldLine", doCounter}).toInt();
-        }
-    } else {
-        dropOuts.startx.clear();
-        dropOuts.endx.clear();
-        dropOuts.fieldLine.clear();
-    }
-
-    return dropOuts;
+    return metaData.fields[fieldNumber].dropOuts;
 }
 
 // This method sets the field metadata for a field
 void LdDecodeMetaData::updateField(LdDecodeMetaData::Field _field, qint32 sequentialFieldNumber)
 {
     if (sequentialFieldNumber < 1) {
-        qCritical() << "LdDecodeMetaData::updateFieldVitsMetrics(): Requested field number" << sequentialFieldNumber << "out of bounds!";
+        qCritical() << "LdDecodeMetaData::updateField(): Requested field number" << sequentialFieldNumber << "out of bounds!";
+        return;
     }
 
     qint32 fieldNumber = sequentialFieldNumber - 1;
 
+    // Extend the fields if required
+    if (fieldNumber >= getNumberOfFields()) {
+        qint32 oldNumberOfFields = getNumberOfFields();
+        metaData.fields.resize(fieldNumber + 1);
+        for (qint32 i = oldNumberOfFields; i <= fieldNumber; i++) metaData.fields[i].vbi.vbiData.resize(3);
+        isFrameIndexValid = false;
+    }
+
     // Write the field data
-    json.setValue({"fields", fieldNumber, "seqNo"}, sequentialFieldNumber);
-    json.setValue({"fields", fieldNumber, "isFirstField"}, _field.isFirstField);
-    json.setValue({"fields", fieldNumber, "syncConf"}, _field.syncConf);
-    json.setValue({"fields", fieldNumber, "medianBurstIRE"}, _field.medianBurstIRE);
-    json.setValue({"fields", fieldNumber, "fieldPhaseID"}, _field.fieldPhaseID);
-    json.setValue({"fields", fieldNumber, "audioSamples"}, _field.audioSamples);
+    Field &field = metaData.fields[fieldNumber];
+    if (field.isFirstField != _field.isFirstField) isFrameIndexValid = false;
+    field.seqNo = sequentialFieldNumber;
+    field.isFirstField = _field.isFirstField;
+    field.syncConf = _field.syncConf;
+    field.medianBurstIRE = _field.medianBurstIRE;
+    field.fieldPhaseID = _field.fieldPhaseID;
+    field.audioSamples = _field.audioSamples;
+    field.diskLoc = _field.diskLoc;
+    field.decodeFaults = _field.decodeFaults;
 
     // Write the VITS metrics data if in use
     updateFieldVitsMetrics(_field.vitsMetrics, sequentialFieldNumber);
@@ -380,21 +1253,39 @@ void LdDecodeMetaData::updateField(LdDecodeMetaData::Field _field, qint32 sequen
     updateFieldDropOuts(_field.dropOuts, sequentialFieldNumber);
 
     // Padding flag
-    json.setValue({"fields", fieldNumber, "pad"}, _field.pad);
+    field.pad = _field.pad;
+}
+
+// Check that a field (indexed from 0) can be updated, adding it if it is the
+// next field after the existing fields.  Returns false if it is out of bounds
+bool LdDecodeMetaData::prepareFieldForUpdate(qint32 fieldNumber, const char *caller)
+{
+    if (fieldNumber >= getNumberOfFields() + 1 || fieldNumber < 0) {
+        qCritical() << caller << "Requested field number" << fieldNumber + 1 << "out of bounds!";
+        return false;
+    }
+
+    if (fieldNumber == getNumberOfFields()) {
+        metaData.fields.resize(fieldNumber + 1);
+        metaData.fields[fieldNumber].seqNo = fieldNumber + 1;
+        metaData.fields[fieldNumber].vbi.vbiData.resize(3);
+        isFrameIndexValid = false;
+    }
+
+    // Record the update in the journal (if one is open)
+    if (journalFile.isOpen()) journalPendingFields.append(fieldNumber);
+
+    return true;
 }
 
 // This method sets the field VBI metadata for a field
 void LdDecodeMetaData::updateFieldVitsMetrics(LdDecodeMetaData::VitsMetrics _vitsMetrics, qint32 sequentialFieldNumber)
 {
     qint32 fieldNumber = sequentialFieldNumber - 1;
-
-    if (fieldNumber >= getNumberOfFields() + 1 || fieldNumber < 0) {
-        qCritical() << "LdDecodeMetaData::updateFieldVitsMetrics(): Requested field number" << sequentialFieldNumber << "out of bounds!";
-    }
+    if (!prepareFieldForUpdate(fieldNumber, "LdDecodeMetaData::updateFieldVitsMetrics():")) return;
 
     if (_vitsMetrics.inUse) {
-        json.setValue({"fields", fieldNumber, "vitsMetrics", "wSNR"}, _vitsMetrics.wSNR);
-        json.setValue({"fields", fieldNumber, "vitsMetrics", "bPSNR"}, _vitsMetrics.bPSNR);
+        metaData.fields[fieldNumber].vitsMetrics = _vitsMetrics;
     }
 }
 
@@ -402,10 +1293,7 @@ void LdDecodeMetaData::updateFieldVitsMetrics(LdDecodeMetaData::VitsMetrics _vit
 void LdDecodeMetaData::updateFieldVbi(LdDecodeMetaData::Vbi _vbi, qint32 sequentialFieldNumber)
 {
     qint32 fieldNumber = sequentialFieldNumber - 1;
-
-    if (fieldNumber >= getNumberOfFields() + 1 || fieldNumber < 0) {
-        qCritical() << "LdDecodeMetaData::updateFieldVbi(): Requested field number" << sequentialFieldNumber << "out of bounds!";
-    }
+    if (!prepareFieldForUpdate(fieldNumber, "LdDecodeMetaData::updateFieldVbi():")) return;
 
     if (_vbi.inUse) {
         // Validate the VBI data array
@@ -417,9 +1305,7 @@ void LdDecodeMetaData::updateFieldVbi(LdDecodeMetaData::Vbi _vbi, qint32 sequent
             _vbi.vbiData[2] = -1;
         }
 
-        json.setValue({"fields", fieldNumber, "vbi", "vbiData", 0}, _vbi.vbiData[0]);
-        json.setValue({"fields", fieldNumber, "vbi", "vbiData", 1}, _vbi.vbiData[1]);
-        json.setValue({"fields", fieldNumber, "vbi", "vbiData", 2}, _vbi.vbiData[2]);
+        metaData.fields[fieldNumber].vbi = _vbi;
     }
 }
 
@@ -427,20 +1313,11 @@ void LdDecodeMetaData::updateFieldVbi(LdDecodeMetaData::Vbi _vbi, qint32 sequent
 void LdDecodeMetaData::updateFieldNtsc(LdDecodeMetaData::Ntsc _ntsc, qint32 sequentialFieldNumber)
 {
     qint32 fieldNumber = sequentialFieldNumber - 1;
-
-    if (fieldNumber >= getNumberOfFields() + 1 || fieldNumber < 0) {
-        qCritical() << "LdDecodeMetaData::updateFieldNtsc(): Requested field number" << sequentialFieldNumber << "out of bounds!";
-    }
+    if (!prepareFieldForUpdate(fieldNumber, "LdDecodeMetaData::updateFieldNtsc():")) return;
 
     if (_ntsc.inUse) {
-        json.setValue({"fields", fieldNumber, "ntsc", "isFmCodeDataValid"}, _ntsc.isFmCodeDataValid);
-        if (_ntsc.isFmCodeDataValid)
-            json.setValue({"fields", fieldNumber, "ntsc", "fmCodeData"}, _ntsc.fmCodeData);
-        else json.setValue({"fields", fieldNumber, "ntsc", "fmCodeData"}, -1);
-        json.setValue({"fields", fieldNumber, "ntsc", "fieldFlag"}, _ntsc.fieldFlag);
-        json.setValue({"fields", fieldNumber, "ntsc", "whiteFlag"}, _ntsc.whiteFlag);
-        json.setValue({"fields", fieldNumber, "ntsc", "ccData0"}, _ntsc.ccData0);
-        json.setValue({"fields", fieldNumber, "ntsc", "ccData1"}, _ntsc.ccData1);
+        if (!_ntsc.isFmCodeDataValid) _ntsc.fmCodeData = -1;
+        metaData.fields[fieldNumber].ntsc = _ntsc;
     }
 }
 
@@ -448,35 +1325,23 @@ void LdDecodeMetaData::updateFieldNtsc(LdDecodeMetaData::Ntsc _ntsc, qint32 sequ
 void LdDecodeMetaData::updateFieldDropOuts(LdDecodeMetaData::DropOuts _dropOuts, qint32 sequentialFieldNumber)
 {
     qint32 fieldNumber = sequentialFieldNumber - 1;
-
-    if (fieldNumber >= getNumberOfFields() + 1 || fieldNumber < 0) {
-        qCritical() << "LdDecodeMetaData::updateFieldDropOuts(): Requested field number" << sequentialFieldNumber << "out of bounds!";
-    }
+    if (!prepareFieldForUpdate(fieldNumber, "LdDecodeMetaData::updateFieldDropOuts():")) return;
 
     if (_dropOuts.startx.size() != 0) {
-        // Populate the arrays with the drop out metadata
-        for (qint32 doCounter = 0; doCounter < _dropOuts.startx.size(); doCounter++) {
-            json.setValue({"fields", fieldNumber, "dropOuts", "startx", doCounter}, _dropOuts.startx[doCounter]);
-            json.setValue({"fields", fieldNumber, "dropOuts", "endx", doCounter}, _dropOuts.endx[doCounter]);
-            json.setValue({"fields", fieldNumber, "dropOuts", "fieldLine", doCounter}, _dropOuts.fieldLine[doCounter]);
-        }
+        metaData.fields[fieldNumber].dropOuts = _dropOuts;
     }
 }
 
 // This method appends a new field to the existing metadata
 void LdDecodeMetaData::appendField(LdDecodeMetaData::Field _field)
 {
-    // Get the field number (and adjust to 0 if there are no fields in the JSON)
-    qint32 fieldNumber = getNumberOfFields();
-    if (fieldNumber < 0) fieldNumber = 0;
-
-    updateField(_field, fieldNumber + 1);
+    updateField(_field, getNumberOfFields() + 1);
 }
 
 // Method to get the available number of fields (according to the metadata)
-qint32 LdDecodeMetaData::getNumberOfFields()
+qint32 LdDecodeMetaData::getNumberOfFields() const
 {
-    return json.size({"fields"});
+    return metaData.fields.size();
 }
 
 // A note about fields, frames and still-frames:
@@ -540,93 +1405,123 @@ qint32 LdDecodeMetaData::getNumberOfFields()
 // the shared-library scope.
 
 // Method to get the available number of still-frames
-qint32 LdDecodeMetaData::getNumberOfFrames()
+qint32 LdDecodeMetaData::getNumberOfFrames() const
 {
     qint32 frameOffset = 0;
+    bool isTbcFirstFieldFirst = !metaData.fields.isEmpty() && metaData.fields[0].isFirstField;
 
     // If the first field in the TBC input isn't the expected first field,
     // skip it when counting the number of still-frames
-    if (isFirstFieldFirst) {
-        // Expecting first field first
-        if (!getField(1).isFirstField) frameOffset = 1;
-    } else {
-        // Expecting second field first
-        if (getField(1).isFirstField) frameOffset = 1;
-    }
+    if (isFirstFieldFirst != isTbcFirstFieldFirst) frameOffset = 1;
 
     return (getNumberOfFields() / 2) - frameOffset;
 }
 
-// Method to get the first and second field numbers based on the frame number
-// If field = 1 return the firstField, otherwise return second field
-qint32 LdDecodeMetaData::getFieldNumber(qint32 frameNumber, qint32 field)
+// Build the index of the first and second field numbers of each frame.
+//
+// The fields of a frame are found from the frame's position in the TBC; if
+// the field at the position of the first field doesn't have isFirstField
+// set, both positions move forward until it does (which copes with fields
+// missing from the TBC).  Problems with the TBC are reported once here,
+// rather than on every lookup
+void LdDecodeMetaData::buildFrameIndex() const
 {
-    qint32 firstFieldNumber = 0;
-    qint32 secondFieldNumber = 0;
-
-    // Verify the frame number
-    if (frameNumber < 1) {
-        qCritical() << "Invalid frame number, cannot determine fields";
-        return -1;
+    const qint32 numberOfFields = getNumberOfFields();
+    const qint32 numberOfFrames = numberOfFields / 2;
+
+    // Find the next field (from each field number onwards) with isFirstField set
+    QVector<qint32> nextFirstFieldNumbers(numberOfFields + 2);
+    nextFirstFieldNumbers[numberOfFields + 1] = -1;
+    for (qint32 fieldNumber = numberOfFields; fieldNumber >= 1; fieldNumber--) {
+        if (metaData.fields[fieldNumber - 1].isFirstField) nextFirstFieldNumbers[fieldNumber] = fieldNumber;
+        else nextFirstFieldNumbers[fieldNumber] = nextFirstFieldNumbers[fieldNumber + 1];
     }
 
-    // Calculate the first and last fields based on the position in the TBC
-    if (isFirstFieldFirst) {
-        // Expecting TBC file to provide still-frames as first field / second field
-        firstFieldNumber = (frameNumber * 2) - 1;
-        secondFieldNumber = firstFieldNumber + 1;
-    } else {
-        // Expecting TBC file to provide still-frames as second field / first field
-        secondFieldNumber = (frameNumber * 2) - 1;
-        firstFieldNumber = secondFieldNumber + 1;
-    }
+    frameFirstFieldNumbers.resize(numberOfFrames);
+    frameSecondFieldNumbers.resize(numberOfFrames);
+    qint32 unresolvedFrames = 0;
+    qint32 brokenFrames = 0;
+
+    for (qint32 frameNumber = 1; frameNumber <= numberOfFrames; frameNumber++) {
+        qint32 firstFieldNumber;
+        qint32 secondFieldNumber;
+
+        // Calculate the first and last fields based on the position in the TBC
+        if (isFirstFieldFirst) {
+            // Expecting TBC file to provide still-frames as first field / second field
+            firstFieldNumber = (frameNumber * 2) - 1;
+            secondFieldNumber = firstFieldNumber + 1;
+        } else {
+            // Expecting TBC file to provide still-frames as second field / first field
+            secondFieldNumber = (frameNumber * 2) - 1;
+            firstFieldNumber = secondFieldNumber + 1;
+        }
 
-    // If the field number pointed to by firstFieldNumber doesn't have
-    // isFirstField set, move forward field by field until the current
-    // field does
-    while (!getField(firstFieldNumber).isFirstField) {
-        firstFieldNumber++;
-        secondFieldNumber++;
+        // Move forward to the next field with isFirstField set
+        qint32 nextFirstFieldNumber = nextFirstFieldNumbers[firstFieldNumber];
+        if (nextFirstFieldNumber != -1) {
+            secondFieldNumber += nextFirstFieldNumber - firstFieldNumber;
+            firstFieldNumber = nextFirstFieldNumber;
+        }
 
-        // Give up if we reach the end of the available fields
-        if (firstFieldNumber > getNumberOfFields() || secondFieldNumber > getNumberOfFields()) {
-            qCritical() << "Attempting to get field number failed - no isFirstField in JSON before end of file";
+        if (nextFirstFieldNumber == -1 || secondFieldNumber > numberOfFields) {
+            // There's no isFirstField before the end of the available fields
             firstFieldNumber = -1;
             secondFieldNumber = -1;
-            break;
+            unresolvedFrames++;
+        } else if (metaData.fields[secondFieldNumber - 1].isFirstField) {
+            // Test for a buggy TBC file...
+            brokenFrames++;
         }
+
+        frameFirstFieldNumbers[frameNumber - 1] = firstFieldNumber;
+        frameSecondFieldNumbers[frameNumber - 1] = secondFieldNumber;
     }
 
-    // Range check the first field number
-    if (firstFieldNumber > getNumberOfFields()) {
-        qCritical() << "LdDecodeMetaData::getFieldNumber(): First field number exceed the available number of fields!";
-        firstFieldNumber = -1;
-        secondFieldNumber = -1;
+    isFrameIndexValid = true;
+
+    if (unresolvedFrames > 0) {
+        qCritical() << "LdDecodeMetaData::buildFrameIndex(): Could not determine the field numbers of" << unresolvedFrames <<
+                       "frames - no isFirstField in JSON before end of file";
     }
+    if (brokenFrames > 0) {
+        qCritical() << "LdDecodeMetaData::buildFrameIndex():" << brokenFrames <<
+                       "frames have isFirstField set on both of the determined fields - the TBC source video is probably broken...";
+    }
+}
 
-    // Range check the second field number
-    if (secondFieldNumber > getNumberOfFields()) {
-        qCritical() << "LdDecodeMetaData::getFieldNumber(): Second field number exceed the available number of fields!";
-        firstFieldNumber = -1;
-        secondFieldNumber = -1;
+// Method to get the first and second field numbers based on the frame number
+// If field = 1 return the firstField, otherwise return second field
+qint32 LdDecodeMetaData::getFieldNumber(qint32 frameNumber, qint32 field) const
+{
+    // Verify the frame number
+    if (frameNumber < 1) {
+        qCritical() << "Invalid frame number, cannot determine fields";
+        return -1;
     }
 
-    // Test for a buggy TBC file...
-    if (getField(secondFieldNumber).isFirstField) {
-        qCritical() << "LdDecodeMetaData::getFieldNumber(): Both of the determined fields have isFirstField set - the TBC source video is probably broken...";
+    // Several threads may look up frames at once, so the lazy rebuild of the
+    // index (and reading it) is serialised
+    QMutexLocker locker(&frameIndexMutex);
+    if (!isFrameIndexValid) buildFrameIndex();
+
+    if (frameNumber > frameFirstFieldNumbers.size()) {
+        qCritical() << "LdDecodeMetaData::getFieldNumber(): Frame number" << frameNumber << "exceeds the available number of frames!";
+        return -1;
     }
 
-    if (field == 1) return firstFieldNumber; else return secondFieldNumber;
+    if (field == 1) return frameFirstFieldNumbers[frameNumber - 1];
+    else return frameSecondFieldNumbers[frameNumber - 1];
 }
 
 // Method to get the first field number based on the frame number
-qint32 LdDecodeMetaData::getFirstFieldNumber(qint32 frameNumber)
+qint32 LdDecodeMetaData::getFirstFieldNumber(qint32 frameNumber) const
 {
     return getFieldNumber(frameNumber, 1);
 }
 
 // Method to get the second field number based on the frame number
-qint32 LdDecodeMetaData::getSecondFieldNumber(qint32 frameNumber)
+qint32 LdDecodeMetaData::getSecondFieldNumber(qint32 frameNumber) const
 {
     return getFieldNumber(frameNumber, 2);
 }
@@ -634,11 +1529,14 @@ qint32 LdDecodeMetaData::getSecondFieldNumber(qint32 frameNumber)
 // Method to set the isFirstFieldFirst flag
 void LdDecodeMetaData::setIsFirstFieldFirst(bool flag)
 {
+    if (flag == isFirstFieldFirst && isFrameIndexValid) return;
+
     isFirstFieldFirst = flag;
+    buildFrameIndex();
 }
 
 // Method to get the isFirstFieldFirst flag
-bool LdDecodeMetaData::getIsFirstFieldFirst()
+bool LdDecodeMetaData::getIsFirstFieldFirst() const
 {
     return isFirstFieldFirst;
 }
@@ -26,23 +26,31 @@
 #define LDDECODEMETADATA_H
 
 #include <QObject>
+#include <QFile>
+#include <QMutex>
 #include <QVector>
-#include <QTemporaryFile>
 #include <QDebug>
 
-#include "../JsonWax/JsonWax.h"
+class JsonReader;
+class JsonWriter;
 
 class LdDecodeMetaData : public QObject
 {
     Q_OBJECT
 public:
 
+    // Each of the structures that is read from a JSON object keeps any
+    // members of the object that it doesn't know about in otherMembers, as
+    // JSON text ("name":value pairs, separated by commas), so they are
+    // written back unchanged
+
     // VBI Metadata definition
     struct Vbi {
         Vbi() : inUse(false) {}
 
         bool inUse;
         QVector<qint32> vbiData;
+        QByteArray otherMembers;
     };
 
     // Video metadata definition
@@ -65,6 +73,7 @@ public:
         qint32 fsc;
 
         bool isMapped;
+        QByteArray otherMembers;
     };
 
     // Drop-outs metadata definition
@@ -72,6 +81,7 @@ public:
         QVector<qint32> startx;
         QVector<qint32> endx;
         QVector<qint32> fieldLine;
+        QByteArray otherMembers;
     };
 
     // VITS metrics metadata definition
@@ -81,6 +91,7 @@ public:
         bool inUse;
         qreal wSNR;
         qreal bPSNR;
+        QByteArray otherMembers;
     };
 
     // NTSC Specific metadata definition
@@ -95,6 +106,7 @@ public:
         bool whiteFlag;
         qint32 ccData0;
         qint32 ccData1;
+        QByteArray otherMembers;
     };
 
     // PCM sound metadata definition
@@ -103,12 +115,13 @@ public:
         bool isLittleEndian;
         bool isSigned;
         qint32 bits;
+        QByteArray otherMembers;
     };
 
     // Field metadata definition
     struct Field {
         Field() : seqNo(0), isFirstField(false), syncConf(0), medianBurstIRE(0),
-            fieldPhaseID(0), audioSamples(0), pad(false) {}
+            fieldPhaseID(0), audioSamples(0), diskLoc(-1), decodeFaults(-1), pad(false) {}
 
         qint32 seqNo;       // Note: This is the unique primary-key
         bool isFirstField;
@@ -116,12 +129,15 @@ public:
         qreal medianBurstIRE;
         qint32 fieldPhaseID;
         qint32 audioSamples;
+        qreal diskLoc;          // -1 if not present
+        qint32 decodeFaults;    // -1 if not present
 
         VitsMetrics vitsMetrics;
         Vbi vbi;
         Ntsc ntsc;
         DropOuts dropOuts;
         bool pad;
+        QByteArray otherMembers;
     };
 
     // Overall metadata definition
@@ -129,6 +145,7 @@ public:
         VideoParameters videoParameters;
         PcmAudioParameters pcmAudioParameters;
         QVector<Field> fields;
+        QByteArray otherMembers;
     };
 
     // CLV timecode (used by frame number conversion methods)
@@ -139,26 +156,50 @@ public:
         qint32 pictureNumber;
     };
 
+    // Optional sections of the field metadata, which can be left out when
+    // reading to save time and memory (see setLoadedFieldSections())
+    enum FieldSection {
+        VitsMetricsSection = 0x1,
+        VbiSection = 0x2,
+        NtscSection = 0x4,
+        DropOutsSection = 0x8,
+        AllFieldSections = 0xF
+    };
+    Q_DECLARE_FLAGS(FieldSections, FieldSection)
+
     explicit LdDecodeMetaData(QObject *parent = nullptr);
 
+    void setLoadedFieldSections(FieldSections sections);
+    FieldSections getLoadedFieldSections() const;
+
     bool read(QString fileName);
     bool write(QString fileName);
+    bool readBinary(QString fileName);
+    bool writeBinary(QString fileName);
     bool writeVitsCsv(QString fileName);
 
+    // Append-only journal of field updates
+    static QString getJournalFileName(QString fileName);
+    bool openJournal(QString fileName, QString sourceFileName);
+    bool flushJournal();
+    void closeJournal();
+    bool removeJournal();
+    bool isFieldJournalled(qint32 sequentialFieldNumber) const;
+
     QString escapedString(QString unescapedString);
 
-    VideoParameters getVideoParameters();
+    VideoParameters getVideoParameters() const;
     void setVideoParameters (VideoParameters _videoParameters);
 
-    PcmAudioParameters getPcmAudioParameters();
+    PcmAudioParameters getPcmAudioParameters() const;
     void setPcmAudioParameters(PcmAudioParameters _pcmAudioParam);
 
     // Get field metadata
-    Field getField(qint32 sequentialFieldNumber);
-    VitsMetrics getFieldVitsMetrics(qint32 sequentialFieldNumber);
-    Vbi getFieldVbi(qint32 sequentialFieldNumber);
-    Ntsc getFieldNtsc(qint32 sequentialFieldNumber);
-    DropOuts getFieldDropOuts(qint32 sequentialFieldNumber);
+    Field getField(qint32 sequentialFieldNumber) const;
+    VitsMetrics getFieldVitsMetrics(qint32 sequentialFieldNumber) const;
+    Vbi getFieldVbi(qint32 sequentialFieldNumber) const;
+    Ntsc getFieldNtsc(qint32 sequentialFieldNumber) const;
+    DropOuts getFieldDropOuts(qint32 sequentialFieldNumber) const;
 
     // Set field metadata
     void updateField(Field _field, qint32 sequentialFieldNumber);
@@ -169,13 +210,13 @@ public:
 
     void appendField(Field _field);
 
-    qint32 getNumberOfFields();
-    qint32 getNumberOfFrames();
-    qint32 getFirstFieldNumber(qint32 frameNumber);
-    qint32 getSecondFieldNumber(qint32 frameNumber);
+    qint32 getNumberOfFields() const;
+    qint32 getNumberOfFrames() const;
+    qint32 getFirstFieldNumber(qint32 frameNumber) const;
+    qint32 getSecondFieldNumber(qint32 frameNumber) const;
 
     void setIsFirstFieldFirst(bool flag);
-    bool getIsFirstFieldFirst();
+    bool getIsFirstFieldFirst() const;
 
     qint32 convertClvTimecodeToFrameNumber(LdDecodeMetaData::ClvTimecode clvTimeCode);
     LdDecodeMetaData::ClvTimecode convertFrameNumberToClvTimecode(qint32 clvFrameNumber);
@@ -185,10 +226,45 @@ signals:
 public slots:
 
 private:
-    JsonWax json;
+    // The metadata is held natively; JSON and the binary format are only
+    // used when reading and writing files
+    MetaData metaData;
+    bool hasVideoParameters;
+    bool hasPcmAudioParameters;
     bool isFirstFieldFirst;
-
-    qint32 getFieldNumber(qint32 frameNumber, qint32 field);
+    FieldSections loadedFieldSections;
+
+    bool readJson(QString fileName);
+    bool readJsonVideoParameters(JsonReader &reader);
+    bool readJsonPcmAudioParameters(JsonReader &reader);
+    void readJsonField(JsonReader &reader, Field &field);
+    bool writeJson(QString fileName);
+    void writeJsonField(JsonWriter &writer, const Field &field);
+    bool isBinaryFile(QString fileName);
+    bool areAllFieldSectionsLoaded(const char *caller) const;
+    bool prepareFieldForUpdate(qint32 fieldNumber, const char *caller);
+
+    // Index of the first and second field numbers of each frame.  This is
+    // rebuilt when the field order is changed, and (on the next lookup)
+    // after fields have been added or updated.  Lookups hold frameIndexMutex,
+    // as const methods may be called from several threads at once
+    mutable QVector<qint32> frameFirstFieldNumbers;
+    mutable QVector<qint32> frameSecondFieldNumbers;
+    mutable bool isFrameIndexValid;
+    mutable QMutex frameIndexMutex;
+
+    // Journal state (see openJournal()).  journalPendingFields holds the
+    // (0-based) numbers of the fields updated since the last flush
+    QFile journalFile;
+    QVector<qint32> journalPendingFields;
+    QVector<bool> journalledFields;
+
+    bool replayJournal(qint64 sourceSize, qint64 sourceModified);
+
+    void buildFrameIndex() const;
+    qint32 getFieldNumber(qint32 frameNumber, qint32 field) const;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(LdDecodeMetaData::FieldSections)
+
 #endif // LDDECODEMETADATA_H
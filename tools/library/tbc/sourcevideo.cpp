@@ -24,6 +24,28 @@
 
 #include "sourcevideo.h"
 
+#include "fieldcompressor.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include <limits>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Definitions of static constexpr data members, for compatibility with
+// pre-C++17 compilers
+constexpr qint32 SourceVideo::DEFAULT_PREFETCH_DEPTH;
+constexpr qint32 SourceVideo::DEFAULT_STREAM_WINDOW;
+constexpr qint32 SourceVideo::DEFAULT_CACHE_SIZE;
+
+// Default field cache size for new SourceVideo objects, in bytes (-1 if not yet set)
+qint64 SourceVideo::defaultCacheBytes = -1;
+
 // Class constructor
 SourceVideo::SourceVideo(QObject *parent) : QObject(parent)
 {
@@ -33,13 +55,44 @@ SourceVideo::SourceVideo(QObject *parent) : QObject(parent)
     fieldByteLength = -1;
     fieldLineLength = -1;
 
-    // Set up the cache
-    fieldCache.setMaxCost(100);
+    // Memory map the input where possible
+    useMemoryMapping = true;
+    accessPattern = sequentialAccess;
+    mappedData = nullptr;
+    mappedLength = 0;
+    isCompressed = false;
+
+    // Read ahead of sequential consumers by default
+    prefetchDepth = DEFAULT_PREFETCH_DEPTH;
+#ifdef Q_OS_UNIX
+    pageSize = sysconf(_SC_PAGESIZE);
+#else
+    pageSize = 4096;
+#endif
+    prefetchStart = 0;
+    prefetchEnd = 0;
+    prefetchStatistics = PrefetchStatistics();
+
+    // Streaming input state
+    isStreamingInput = false;
+    streamWindowSize = DEFAULT_STREAM_WINDOW;
+    streamStart = 0;
+    streamEnd = 0;
+
+    // Set up the cache.  Unless the application has set a default size, the
+    // size in megabytes can be given by the LD_CACHE_SIZE environment variable
+    if (defaultCacheBytes == -1) {
+        bool isValid = false;
+        qint32 megabytes = qEnvironmentVariableIntValue("LD_CACHE_SIZE", &isValid);
+        if (!isValid || megabytes < 0) megabytes = DEFAULT_CACHE_SIZE;
+        setDefaultCacheSize(megabytes);
+    }
+    fieldCache.setMaxBytes(defaultCacheBytes);
 }
 
 SourceVideo::~SourceVideo()
 {
-    if (isSourceVideoOpen) inputFile.close();
+    if (isSourceVideoOpen) close();
 }
 
 // Source Video file manipulation methods -----------------------------------------------------------------------------
@@ -59,9 +112,15 @@ bool SourceVideo::open(QString filename, qint32 _fieldLength, qint32 _fieldLineL
         return false;
     }
 
-    // Open the source video file
-    inputFile.setFileName(filename);
-    if (!inputFile.open(QIODevice::ReadOnly)) {
+    // Open the source video file ("-" reads from stdin)
+    bool openSuccess;
+    if (filename == "-") {
+        openSuccess = inputFile.open(stdin, QIODevice::ReadOnly);
+    } else {
+        inputFile.setFileName(filename);
+        openSuccess = inputFile.open(QIODevice::ReadOnly);
+    }
+    if (!openSuccess) {
         // Failed to open input file
         qWarning() << "Could not open " << filename << "as source video input file";
         isSourceVideoOpen = false;
@@ -70,12 +129,70 @@ bool SourceVideo::open(QString filename, qint32 _fieldLength, qint32 _fieldLineL
 
     // File open successful - configure source video parameters
     isSourceVideoOpen = true;
-    qint64 tAvailableFields = (inputFile.size() / fieldByteLength);
-    availableFields = static_cast<qint32>(tAvailableFields);
+
+    // Is the input a pipe rather than a file?
+    isStreamingInput = inputFile.isSequential();
+
+    // Is the file a compressed TBC container?
+    qint32 compressedFieldByteLength;
+    isCompressed = FieldCompressor::parseHeader(inputFile.peek(FieldCompressor::HEADER_SIZE), compressedFieldByteLength);
+    if (isCompressed && isStreamingInput) {
+        qWarning() << "Compressed TBC files cannot be read from a pipe";
+        close();
+        return false;
+    }
+    if (isCompressed) {
+        if (compressedFieldByteLength != fieldByteLength) {
+            qWarning() << "Compressed TBC file" << filename << "has a field length of" << compressedFieldByteLength <<
+                          "bytes, but" << fieldByteLength << "bytes were expected";
+            close();
+            return false;
+        }
+
+        if (!readCompressedIndex()) {
+            qWarning() << "Compressed TBC file" << filename << "has a missing or invalid field index";
+            close();
+            return false;
+        }
+        availableFields = fieldOffsets.size() - 1;
+        qDebug() << "SourceVideo::open(): Source video file is a compressed TBC file";
+    } else if (isStreamingInput) {
+        // The number of fields isn't known until the end of the stream
+        availableFields = -1;
+        streamWindow.clear();
+        streamWindow.resize(streamWindowSize);
+        streamStart = 0;
+        streamEnd = 0;
+        qDebug() << "SourceVideo::open(): Source video is streamed, keeping a window of" << streamWindowSize << "fields";
+    } else {
+        qint64 tAvailableFields = (inputFile.size() / fieldByteLength);
+        availableFields = static_cast<qint32>(tAvailableFields);
+    }
     qDebug() << "SourceVideo::open(): Successful -" << availableFields << "fields available";
 
     // Initialise cache
     fieldCache.clear();
+    fieldCache.resetStatistics();
+
+    // Map the whole file into memory if possible; fields are then returned as
+    // read-only views into the mapping rather than being read and copied.
+    // If the mapping fails (e.g. on a 32-bit system) normal file reads are used
+    mappedData = nullptr;
+    mappedLength = isStreamingInput ? 0 : getFieldPosition(availableFields);
+    if (useMemoryMapping && mappedLength > 0) {
+        mappedData = inputFile.map(0, mappedLength);
+        if (mappedData == nullptr) {
+            qDebug() << "SourceVideo::open(): Memory mapping failed, using file reads -" << inputFile.errorString();
+        } else {
+            qDebug() << "SourceVideo::open(): Source video file is memory mapped";
+            applyAccessPattern();
+        }
+    }
+
+    // Reset the read-ahead window and statistics
+    prefetchStart = 0;
+    prefetchEnd = 0;
+    prefetchStatistics = PrefetchStatistics();
 
     return true;
 }
@@ -89,8 +206,27 @@ void SourceVideo::close()
     }
 
     qDebug() << "SourceVideo::close(): Called, closing the source video file and emptying the frame cache";
+    if (isPrefetchActive()) {
+        qDebug() << "SourceVideo::close(): Read-ahead statistics -" << prefetchStatistics.hits << "hits," <<
+                    prefetchStatistics.misses << "misses," << prefetchStatistics.stallTime / 1000000 << "mS stalled";
+    }
+    FieldCache::Statistics cacheStatistics = fieldCache.getStatistics();
+    if (cacheStatistics.hits + cacheStatistics.misses > 0) {
+        qDebug() << "SourceVideo::close(): Field cache statistics -" << cacheStatistics.hits << "hits," <<
+                    cacheStatistics.misses << "misses," << cacheStatistics.evictions << "evictions";
+    }
+    if (mappedData != nullptr) {
+        inputFile.unmap(mappedData);
+        mappedData = nullptr;
+        mappedLength = 0;
+    }
+    fieldCache.clear();
     inputFile.close();
     isSourceVideoOpen = false;
+    isCompressed = false;
+    fieldOffsets.clear();
+    isStreamingInput = false;
+    streamWindow.clear();
 
     qDebug() << "SourceVideo::close(): Source video input file closed";
 }
@@ -101,7 +237,8 @@ bool SourceVideo::isSourceValid()
     return isSourceVideoOpen;
 }
 
-// Get the number of fields available from the source video file
+// Get the number of fields available from the source video file (or -1 for a
+// streamed input, where the number of fields is not known in advance)
 qint32 SourceVideo::getNumberOfAvailableFields()
 {
     return availableFields;
@@ -113,109 +250,502 @@ qint32 SourceVideo::getFieldByteLength()
     return fieldByteLength;
 }
 
-// Frame data retrieval methods ---------------------------------------------------------------------------------------
+// Memory mapping methods ---------------------------------------------------------------------------------------------
 
-// Method to retrieve a single video frame (with caching to prevent multiple
-// file reads if application requests the same line multiple times)
-QByteArray SourceVideo::getVideoField(qint32 fieldNumber)
+// Enable or disable memory mapping of the source video file (must be set before
+// the file is opened).  Note: Fields returned from a memory mapped source are
+// only valid until the source video is closed
+void SourceVideo::setMemoryMapping(bool enabled)
 {
-    // Adjust the field number to index from zero
-    fieldNumber--;
+    if (isSourceVideoOpen) {
+        qDebug() << "SourceVideo::setMemoryMapping(): Called when source video is already open - ignoring";
+        return;
+    }
 
-    // Ensure source video is open and field is in range
-    if (!isSourceVideoOpen) qFatal("Application requested TBC field before opening TBC file - Fatal error");
-    if (fieldNumber < 0 || fieldNumber >= availableFields) qFatal("Application requested non-existant TBC field");
+    useMemoryMapping = enabled;
+}
 
-    // Check the cache
-    if (fieldCache.contains(fieldNumber)) {
-        return *fieldCache.object(fieldNumber);
+// Returns true if the source video file is memory mapped
+bool SourceVideo::isMemoryMapped()
+{
+    return mappedData != nullptr;
+}
+
+// Set the expected access pattern for the source video file
+void SourceVideo::setAccessPattern(AccessPattern pattern)
+{
+    accessPattern = pattern;
+    applyAccessPattern();
+}
+
+// Pass the expected access pattern on to the OS as a hint for read-ahead
+void SourceVideo::applyAccessPattern()
+{
+    if (mappedData == nullptr) return;
+
+#ifdef Q_OS_UNIX
+    qint32 advice = (accessPattern == sequentialAccess) ? POSIX_MADV_SEQUENTIAL : POSIX_MADV_RANDOM;
+    if (posix_madvise(mappedData, static_cast<size_t>(mappedLength), advice) != 0) {
+        qDebug() << "SourceVideo::applyAccessPattern(): posix_madvise failed - ignoring";
     }
+#endif
+}
 
-    // Seek to the correct file position for the requested field (if not already there)
-    qint64 requiredPosition = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber);
-    if (inputFile.pos() != requiredPosition) {
-        if (!inputFile.seek(requiredPosition)) qFatal("Could not seek to required field position in input TBC file");
+// Read-ahead methods -------------------------------------------------------------------------------------------------
+
+// Set how many fields ahead of the last requested field should be prefetched
+// (0 disables read-ahead).  Read-ahead is only performed for sequential access
+void SourceVideo::setPrefetchDepth(qint32 fields)
+{
+    prefetchDepth = qMax(0, fields);
+}
+
+// Get the read-ahead depth in fields
+qint32 SourceVideo::getPrefetchDepth()
+{
+    return prefetchDepth;
+}
+
+// Get the read-ahead statistics (hits, misses and the time consumers have
+// spent waiting for data).  These can be used to tune the read-ahead depth
+SourceVideo::PrefetchStatistics SourceVideo::getPrefetchStatistics()
+{
+    QMutexLocker locker(&prefetchMutex);
+    return prefetchStatistics;
+}
+
+// Returns true if fields should be prefetched
+bool SourceVideo::isPrefetchActive()
+{
+    return prefetchDepth > 0 && accessPattern == sequentialAccess && !isStreamingInput;
+}
+
+// Record whether the requested field (indexed from zero) was prefetched, and
+// move the read-ahead window forwards if it is getting empty.
+//
+// The OS is asked to read the fields in the background (using the page cache),
+// so by the time a consumer requests a field the data should already be resident.
+//
+// The window only ever moves forwards.  Several consumers may be working on
+// different parts of the input at once, and each may look back at fields
+// before the one it's working on, so a request behind the window is counted
+// as a miss but leaves the window where it is
+void SourceVideo::prefetchFields(qint32 fieldNumber)
+{
+    QMutexLocker locker(&prefetchMutex);
+
+    if (fieldNumber < prefetchStart) {
+        prefetchStatistics.misses++;
+        return;
     }
 
-    // Read the frame from disk into the cache
-    qint64 totalReceivedBytes = 0;
-    qint64 receivedBytes = 0;
-    QByteArray *fieldData = new QByteArray;
-    fieldData->resize(fieldByteLength);
+    // Was the field inside the read-ahead window?
+    bool isInWindow = fieldNumber < prefetchEnd;
+    if (isInWindow) prefetchStatistics.hits++;
+    else prefetchStatistics.misses++;
 
-    do {
-        receivedBytes = inputFile.read(fieldData->data(), fieldByteLength - receivedBytes);
-        totalReceivedBytes += receivedBytes;
-    } while (receivedBytes > 0 && totalReceivedBytes < fieldByteLength);
+    // Only move the window once at least half of it has been consumed
+    if (isInWindow && (prefetchEnd - fieldNumber) > (prefetchDepth / 2)) return;
 
-    // Verify read was ok
-    if (receivedBytes != fieldByteLength) qFatal("Could not read input fields from file even though they were available");
+    // Work out the new fields to request
+    qint32 firstField = isInWindow ? prefetchEnd : fieldNumber + 1;
+    qint32 lastField = qMin(fieldNumber + 1 + prefetchDepth, availableFields);
+    if (lastField <= firstField) return;
 
-    // Insert the field data into the cache
-    fieldCache.insert(fieldNumber, fieldData, 1);
+    if (!isInWindow) prefetchStart = fieldNumber;
+    prefetchEnd = lastField;
 
-    // Return the originally request field
-    return *fieldCache.object(fieldNumber);
+    adviseWillNeed(getFieldPosition(firstField), getFieldPosition(lastField) - getFieldPosition(firstField));
 }
 
-// Method to retrieve a range of field lines from a single video frame
-QByteArray SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine)
+// Tell the OS that a byte range of the input file will be needed soon
+void SourceVideo::adviseWillNeed(qint64 position, qint64 length)
 {
-    // Adjust the field number to index from zero
-    fieldNumber--;
+    if (mappedData != nullptr) {
+#ifdef Q_OS_UNIX
+        // posix_madvise requires a page-aligned address
+        qint64 alignedPosition = position - (position % pageSize);
+        if (posix_madvise(mappedData + alignedPosition, static_cast<size_t>(length + position - alignedPosition),
+                          POSIX_MADV_WILLNEED) != 0) {
+            qDebug() << "SourceVideo::adviseWillNeed(): posix_madvise failed - ignoring";
+        }
+#endif
+    } else {
+#ifdef Q_OS_LINUX
+        if (posix_fadvise(inputFile.handle(), static_cast<off_t>(position), static_cast<off_t>(length),
+                          POSIX_FADV_WILLNEED) != 0) {
+            qDebug() << "SourceVideo::adviseWillNeed(): posix_fadvise failed - ignoring";
+        }
+#endif
+    }
+}
 
-    // Adjust the field line range to index from zero
-    startFieldLine--;
-    endFieldLine--;
+// Add to the total time consumers have spent waiting for data
+void SourceVideo::addStallTime(qint64 nanoseconds)
+{
+    QMutexLocker locker(&prefetchMutex);
+    prefetchStatistics.stallTime += nanoseconds;
+}
 
-    // Ensure source video is open and field is in range
-    if (!isSourceVideoOpen) qFatal("Application requested TBC field before opening TBC file - Fatal error");
-    if (fieldNumber < 0 || fieldNumber >= availableFields) qFatal("Application requested non-existant TBC field");
-    if (fieldLineLength == -1) qFatal("Application did not set field line length when opening TBC file");
+// Field cache methods ------------------------------------------------------------------------------------------------
 
-    // Verify the required range
-    if (startFieldLine < 0) qFatal("Application requested out-of-bounds field line");
+// Set the field cache size in megabytes for SourceVideo objects created after
+// this call (applications should call this before creating any, e.g. from a
+// command line option).  This overrides the LD_CACHE_SIZE environment variable
+void SourceVideo::setDefaultCacheSize(qint32 megabytes)
+{
+    defaultCacheBytes = static_cast<qint64>(qMax(0, megabytes)) * 1024 * 1024;
+}
 
-    // Calculate the position of the require field line data
-    qint64 requiredStartPosition = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber);
-    requiredStartPosition += static_cast<qint64>(fieldLineLength) * static_cast<qint64>(startFieldLine);
-    qint64 requiredReadLength = static_cast<qint64>(endFieldLine - startFieldLine + 1) * static_cast<qint64>(fieldLineLength);
+// Add the --cache option, which sets the default field cache size, to a tool's
+// command line parser
+void SourceVideo::addCacheSizeOption(QCommandLineParser &parser)
+{
+    parser.addOption(QCommandLineOption(QStringList() << "cache",
+                                        QCoreApplication::translate("main", "Specify the field cache size in MB for compressed TBC input (default 128, or LD_CACHE_SIZE); uncompressed input is memory mapped instead of cached"),
+                                        QCoreApplication::translate("main", "number")));
+}
 
-    if (requiredStartPosition + requiredReadLength > (static_cast<qint64>(fieldByteLength) * availableFields))
-        qFatal("Application request field line range that exceeds the boundaries of the input TBC file");
+// Apply the --cache option (if specified) once the command line has been
+// processed.  Returns false if the given size is invalid
+bool SourceVideo::applyCacheSizeOption(const QCommandLineParser &parser)
+{
+    if (!parser.isSet("cache")) return true;
 
-    // Resize the output buffer
-    outputFieldLineData.resize(static_cast<qint32>(requiredReadLength));
+    qint32 cacheSize = parser.value("cache").toInt();
+    if (cacheSize < 0) {
+        qCritical("Specified cache size must not be negative");
+        return false;
+    }
+    setDefaultCacheSize(cacheSize);
+
+    return true;
+}
+
+// Set the field cache size in megabytes (0 disables the cache)
+void SourceVideo::setCacheSize(qint32 megabytes)
+{
+    fieldCache.setMaxBytes(static_cast<qint64>(qMax(0, megabytes)) * 1024 * 1024);
+}
+
+// Get the field cache statistics (hits, misses and evictions) since the
+// source video was opened
+FieldCache::Statistics SourceVideo::getCacheStatistics()
+{
+    return fieldCache.getStatistics();
+}
+
+// Streaming methods --------------------------------------------------------------------------------------------------
+
+// Set how many of the most recently read fields are kept when the input is a
+// pipe (must be set before the file is opened).  This must cover the furthest
+// a consumer will look back from the latest field it has requested
+void SourceVideo::setStreamWindow(qint32 fields)
+{
+    if (isSourceVideoOpen) {
+        qDebug() << "SourceVideo::setStreamWindow(): Called when source video is already open - ignoring";
+        return;
+    }
+
+    streamWindowSize = qMax(1, fields);
+}
+
+// Returns true if the input is a pipe, and so can only be read in order
+bool SourceVideo::isStreaming()
+{
+    return isStreamingInput;
+}
+
+// Return a field (indexed from zero) from a streamed input.
+//
+// Fields are read from the stream until the requested field has been reached;
+// earlier fields are kept in the window for consumers that look behind.  The
+// read-ahead statistics count requests for fields already in the window as
+// hits, and the time spent waiting for the stream as stall time
+QByteArray SourceVideo::getStreamField(qint32 fieldNumber)
+{
+    QMutexLocker locker(&streamMutex);
+
+    if (fieldNumber < streamStart) qFatal("Application requested TBC field that is no longer in the streamed input window");
+
+    // Is the field already in the window?
+    if (fieldNumber < streamEnd) {
+        QMutexLocker statisticsLocker(&prefetchMutex);
+        prefetchStatistics.hits++;
+        return streamWindow[fieldNumber % streamWindowSize];
+    }
+
+    // Read forward to the requested field, replacing the oldest fields in the window
+    QElapsedTimer stallTimer;
+    stallTimer.start();
+    while (streamEnd <= fieldNumber) {
+        // Reuse the buffer unless a consumer still holds a reference to it
+        QByteArray &fieldData = streamWindow[streamEnd % streamWindowSize];
+        if (fieldData.size() != fieldByteLength || !fieldData.isDetached()) {
+            fieldData = QByteArray(fieldByteLength, Qt::Uninitialized);
+        }
+
+        if (!readFromStream(fieldData.data(), fieldByteLength))
+            qFatal("Application requested TBC field beyond the end of the streamed input");
+
+        streamEnd++;
+        streamStart = qMax(streamStart, streamEnd - streamWindowSize);
+    }
 
-    // Seek to the correct file position for the requested field (if not already there)
-    if (inputFile.pos() != requiredStartPosition) {
-        if (!inputFile.seek(requiredStartPosition)) qFatal("Could not seek to required field position in input TBC file");
+    {
+        QMutexLocker statisticsLocker(&prefetchMutex);
+        prefetchStatistics.misses++;
+        prefetchStatistics.stallTime += stallTimer.nsecsElapsed();
     }
 
-    // Read the frame from disk into the cache
+    return streamWindow[fieldNumber % streamWindowSize];
+}
+
+// Read the next length bytes from a streamed input.
+// Returns true on success, false at the end of the stream
+bool SourceVideo::readFromStream(char *buffer, qint64 length)
+{
     qint64 totalReceivedBytes = 0;
     qint64 receivedBytes = 0;
     do {
-        receivedBytes = inputFile.read(outputFieldLineData.data(), requiredReadLength - receivedBytes);
-        totalReceivedBytes += receivedBytes;
-    } while (receivedBytes > 0 && totalReceivedBytes < requiredReadLength);
+        receivedBytes = inputFile.read(buffer + totalReceivedBytes, length - totalReceivedBytes);
+        if (receivedBytes > 0) totalReceivedBytes += receivedBytes;
+    } while (receivedBytes > 0 && totalReceivedBytes < length);
+
+    return totalReceivedBytes == length;
+}
+
+// Frame data retrieval methods ---------------------------------------------------------------------------------------
+
+// Method to retrieve a single video frame (with caching to prevent multiple
+// file reads if application requests the same line multiple times)
+QByteArray SourceVideo::getVideoField(qint32 fieldNumber)
+{
+    // Adjust the field number to index from zero
+    fieldNumber--;
+
+    // Ensure source video is open and field is in range
+    if (!isSourceVideoOpen) qFatal("Application requested TBC field before opening TBC file - Fatal error");
+    if (fieldNumber < 0 || (!isStreamingInput && fieldNumber >= availableFields))
+        qFatal("Application requested non-existant TBC field");
+
+    // A streamed input can only be read in order
+    if (isStreamingInput) return getStreamField(fieldNumber);
+
+    // Keep the read-ahead window ahead of the consumer
+    const bool prefetchActive = isPrefetchActive();
+    if (prefetchActive) prefetchFields(fieldNumber);
+
+    // If the file is memory mapped, return a read-only view of the field data
+    if (mappedData != nullptr && !isCompressed) {
+        qint64 requiredPosition = getFieldPosition(fieldNumber);
+        const char *fieldPointer = reinterpret_cast<const char *>(mappedData + requiredPosition);
+
+        if (prefetchActive) {
+            // Touch each page of the field, so that any wait for the data to be
+            // read happens (and is timed) here rather than inside the consumer
+            QElapsedTimer stallTimer;
+            stallTimer.start();
+            volatile char touched = 0;
+            for (qint64 i = 0; i < fieldByteLength; i += pageSize) touched = fieldPointer[i];
+            Q_UNUSED(touched);
+            addStallTime(stallTimer.nsecsElapsed());
+        }
+
+        return QByteArray::fromRawData(fieldPointer, fieldByteLength);
+    }
+
+    // Check the cache
+    QByteArray fieldData;
+    if (fieldCache.find(fieldNumber, fieldData)) return fieldData;
+
+    // Read the field from disk (the cache isn't locked while reading, so other
+    // threads can read different fields at the same time)
+    QElapsedTimer stallTimer;
+    stallTimer.start();
+    if (isCompressed) {
+        if (!readCompressedField(fieldNumber, fieldData))
+            qFatal("Could not decompress input field - the compressed TBC file is corrupt");
+    } else {
+        fieldData.resize(fieldByteLength);
+        if (!readFromFile(getFieldPosition(fieldNumber), fieldData.data(), fieldByteLength))
+            qFatal("Could not read input fields from file even though they were available");
+    }
+    if (prefetchActive) addStallTime(stallTimer.nsecsElapsed());
 
-    // Verify read was ok
-    if (receivedBytes != requiredReadLength) qFatal("Could not read input fields from file even though they were available");
+    // Insert the field data into the cache
+    fieldCache.insert(fieldNumber, fieldData);
+
+    // Return the originally request field
+    return fieldData;
+}
+
+// Method to retrieve a range of field lines from a single video frame
+QByteArray SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine)
+{
+    FieldRegion region = getVideoFieldRegion(fieldNumber, startFieldLine, endFieldLine);
 
-    // Return the data
-    return outputFieldLineData;
+    // If the region data holds exactly the requested lines, return it without copying
+    if (region.dataOffset == 0 && region.data.size() == region.dataLength) return region.data;
+    return region.data.mid(region.dataOffset, region.dataLength);
 }
 
+// Method to retrieve a rectangular region of a single video field.
+//
+// Field lines are numbered from 1 and x positions from 0; both ranges are
+// inclusive, and an endX of -1 selects the rest of the line.  Only the data
+// covering the region is read (or paged in, if the file is memory mapped);
+// if the whole field is already cached, the region is a view of the cached
+// field.  This method is reentrant.
+SourceVideo::FieldRegion SourceVideo::getVideoFieldRegion(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine,
+                                                          qint32 startX, qint32 endX)
+{
+    // Ensure source video is open and field is in range
+    if (!isSourceVideoOpen) qFatal("Application requested TBC field before opening TBC file - Fatal error");
+    if (fieldNumber < 1 || (!isStreamingInput && fieldNumber > availableFields))
+        qFatal("Application requested non-existant TBC field");
+    if (fieldLineLength == -1) qFatal("Application did not set field line length when opening TBC file");
 
+    // Verify the required range
+    const qint32 lineSamples = fieldLineLength / 2;
+    const qint32 fieldLines = fieldByteLength / fieldLineLength;
+    if (endX == -1) endX = lineSamples - 1;
+    if (startFieldLine < 1 || endFieldLine > fieldLines || startFieldLine > endFieldLine)
+        qFatal("Application requested out-of-bounds field line");
+    if (startX < 0 || endX >= lineSamples || startX > endX)
+        qFatal("Application requested out-of-bounds field line samples");
+
+    FieldRegion region;
+    region.startFieldLine = startFieldLine;
+    region.endFieldLine = endFieldLine;
+    region.startX = startX;
+    region.endX = endX;
+    region.lineStride = lineSamples;
+
+    // Calculate the span of the field data covering the region (from the
+    // first sample of the first line to the last sample of the last line)
+    qint64 fieldPosition = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber - 1);
+    qint32 spanStart = ((startFieldLine - 1) * fieldLineLength) + (startX * 2);
+    region.dataLength = ((endFieldLine - startFieldLine) * fieldLineLength) + ((endX - startX + 1) * 2);
+
+    if (isCompressed || isStreamingInput) {
+        // Compressed and streamed fields can only be read whole, so return a view of the field
+        region.data = getVideoField(fieldNumber);
+        region.dataOffset = spanStart;
+    } else if (mappedData != nullptr) {
+        // Return a view of the memory mapped file
+        region.data = QByteArray::fromRawData(reinterpret_cast<const char *>(mappedData + fieldPosition + spanStart),
+                                              region.dataLength);
+        region.dataOffset = 0;
+    } else {
+        // If the whole field is cached, return a view of it; otherwise read just the span
+        if (fieldCache.find(fieldNumber - 1, region.data)) {
+            region.dataOffset = spanStart;
+        } else {
+            region.data.resize(region.dataLength);
+            region.dataOffset = 0;
+            if (!readFromFile(fieldPosition + spanStart, region.data.data(), region.dataLength))
+                qFatal("Could not read input fields from file even though they were available");
+        }
+    }
 
+    region.firstSample = reinterpret_cast<const quint16 *>(region.data.constData() + region.dataOffset);
+    return region;
+}
 
+// Return the byte position of a field (indexed from zero) in the input file.
+// availableFields can be given to get the end position of the last field
+qint64 SourceVideo::getFieldPosition(qint32 fieldNumber)
+{
+    if (isCompressed) return fieldOffsets[fieldNumber];
+    return static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber);
+}
 
+// Read the field index from the end of a compressed TBC file.
+// Returns true on success, false on failure
+bool SourceVideo::readCompressedIndex()
+{
+    const qint64 fileSize = inputFile.size();
+    if (fileSize < FieldCompressor::HEADER_SIZE + FieldCompressor::TRAILER_SIZE) return false;
+
+    // Read the trailer
+    QByteArray trailer(FieldCompressor::TRAILER_SIZE, 0);
+    if (!readFromFile(fileSize - FieldCompressor::TRAILER_SIZE, trailer.data(), trailer.size())) return false;
+
+    qint64 indexPosition;
+    qint32 numberOfFields;
+    if (!FieldCompressor::parseTrailer(trailer, indexPosition, numberOfFields)) return false;
+    if (indexPosition < FieldCompressor::HEADER_SIZE || indexPosition > fileSize - FieldCompressor::TRAILER_SIZE) return false;
+
+    // Check the number of fields against the space between the index position
+    // and the trailer before allocating anything, as the trailer may be corrupt
+    const qint64 indexSize = fileSize - FieldCompressor::TRAILER_SIZE - indexPosition;
+    if (numberOfFields < 0 || numberOfFields > indexSize / 8) return false;
+    if ((static_cast<qint64>(numberOfFields) + 1) * 8 != indexSize) return false;
+    if (indexSize > std::numeric_limits<int>::max()) return false;
+
+    // Read the index
+    QByteArray index(static_cast<int>(indexSize), 0);
+    if (!readFromFile(indexPosition, index.data(), index.size())) return false;
+    if (!FieldCompressor::parseIndex(index, numberOfFields, fieldOffsets)) return false;
+
+    // The last offset is the end of the field records (i.e. the start of the index)
+    return fieldOffsets.last() == indexPosition;
+}
 
+// Read and decompress a field (indexed from zero) from a compressed TBC file.
+// Returns true on success, false on failure
+bool SourceVideo::readCompressedField(qint32 fieldNumber, QByteArray &fieldData)
+{
+    const qint64 recordPosition = fieldOffsets[fieldNumber];
+    const qint32 recordLength = static_cast<qint32>(fieldOffsets[fieldNumber + 1] - recordPosition);
 
+    // Decompress directly from the mapping if possible
+    if (mappedData != nullptr) {
+        return FieldCompressor::decompressField(reinterpret_cast<const char *>(mappedData + recordPosition), recordLength,
+                                                fieldByteLength, fieldData);
+    }
 
+    QByteArray record(recordLength, 0);
+    if (!readFromFile(recordPosition, record.data(), recordLength)) return false;
+    return FieldCompressor::decompressField(record.constData(), recordLength, fieldByteLength, fieldData);
+}
 
+// Read data from the given position in the input file into buffer.
+//
+// This may be called by several threads at once.  Where possible a positional
+// read is used so that the shared file position is not involved; otherwise
+// the seek and read are serialised by fileMutex.
+//
+// Returns true on success, false on failure.
+bool SourceVideo::readFromFile(qint64 position, char *buffer, qint64 length)
+{
+    qint64 totalReceivedBytes = 0;
 
+#ifdef Q_OS_UNIX
+    const int fileDescriptor = inputFile.handle();
+    while (totalReceivedBytes < length) {
+        ssize_t receivedBytes = pread(fileDescriptor, buffer + totalReceivedBytes,
+                                      static_cast<size_t>(length - totalReceivedBytes),
+                                      static_cast<off_t>(position + totalReceivedBytes));
+        if (receivedBytes < 0 && errno == EINTR) continue;
+        if (receivedBytes <= 0) break;
+        totalReceivedBytes += receivedBytes;
+    }
+#else
+    QMutexLocker locker(&fileMutex);
 
+    // Seek to the correct file position (if not already there)
+    if (inputFile.pos() != position) {
+        if (!inputFile.seek(position)) return false;
+    }
 
+    qint64 receivedBytes = 0;
+    do {
+        receivedBytes = inputFile.read(buffer + totalReceivedBytes, length - totalReceivedBytes);
+        if (receivedBytes > 0) totalReceivedBytes += receivedBytes;
+    } while (receivedBytes > 0 && totalReceivedBytes < length);
+#endif
 
+    return totalReceivedBytes == length;
+}
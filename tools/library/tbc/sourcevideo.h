@@ -26,10 +26,25 @@
 #define SOURCEVIDEO_H
 
 #include <QObject>
+#include <QCommandLineParser>
 #include <QFile>
-#include <QCache>
+#include <QMutex>
+#include <QVector>
 #include <QDebug>
 
+#include "fieldcache.h"
+
+// The input may be a raw TBC file, or a compressed TBC container (which is
+// detected automatically and decompressed as fields are requested).
+//
+// The input may also be a pipe (use "-" for stdin).  Fields are then read
+// from the stream in order as they are requested, and only a window of the
+// most recently read fields is kept (see setStreamWindow()), so consumers must
+// request fields in roughly increasing order.
+//
+// Once a file has been opened, getVideoField() may be called by several
+// threads at the same time.  open(), close() and the other set methods must
+// not be called while other threads are reading.
 class SourceVideo : public QObject
 {
     Q_OBJECT
@@ -38,13 +53,74 @@ public:
     explicit SourceVideo(QObject *parent = nullptr);
     ~SourceVideo() override;
 
+    // Expected access pattern (used to give the OS read-ahead hints)
+    enum AccessPattern {
+        sequentialAccess,
+        randomAccess
+    };
+
+    // Read-ahead statistics
+    struct PrefetchStatistics {
+        qint64 hits;            // Fields requested that had already been prefetched
+        qint64 misses;          // Fields requested outside the prefetch window
+        qint64 stallTime;       // Total time spent waiting for field data (nS)
+    };
+
+    // A read-only view of a rectangular region of a field.  Only samples
+    // inside the region may be accessed
+    struct FieldRegion {
+        qint32 startFieldLine;  // First field line (from 1)
+        qint32 endFieldLine;    // Last field line (inclusive)
+        qint32 startX;          // First sample on each line (from 0)
+        qint32 endX;            // Last sample on each line (inclusive)
+        qint32 lineStride;      // Distance between lines, in samples
+
+        QByteArray data;        // Data holding the region (keeps the view valid)
+        qint32 dataOffset;      // Byte offset of the first sample within data
+        qint32 dataLength;      // Byte length from the first to last sample
+        const quint16 *firstSample;
+
+        // Return a pointer to sample startX of the given field line
+        const quint16 *line(qint32 fieldLine) const {
+            return firstSample + ((fieldLine - startFieldLine) * lineStride);
+        }
+
+        // Return the sample at the given field line and x position
+        quint16 sample(qint32 fieldLine, qint32 x) const {
+            return line(fieldLine)[x - startX];
+        }
+    };
+
     // File handling methods
     bool open(QString filename, qint32 _fieldLength, qint32 _fieldLineLength = -1);
     void close(void);
 
+    // Memory mapping methods
+    void setMemoryMapping(bool enabled);
+    bool isMemoryMapped();
+    void setAccessPattern(AccessPattern pattern);
+
+    // Read-ahead methods
+    void setPrefetchDepth(qint32 fields);
+    qint32 getPrefetchDepth();
+    PrefetchStatistics getPrefetchStatistics();
+
+    // Field cache methods
+    static void setDefaultCacheSize(qint32 megabytes);
+    static void addCacheSizeOption(QCommandLineParser &parser);
+    static bool applyCacheSizeOption(const QCommandLineParser &parser);
+    void setCacheSize(qint32 megabytes);
+    FieldCache::Statistics getCacheStatistics();
+
+    // Streaming methods
+    void setStreamWindow(qint32 fields);
+    bool isStreaming();
+
     // Field handling methods
     QByteArray getVideoField(qint32 fieldNumber);
     QByteArray getVideoField(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine);
+    FieldRegion getVideoFieldRegion(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine,
+                                    qint32 startX = 0, qint32 endX = -1);
 
     // Get and set methods
     bool isSourceValid();
@@ -59,10 +135,60 @@ private:
     qint32 fieldByteLength;
     qint32 fieldLineLength;
 
-    QByteArray outputFieldLineData;
-
-    // Field caching
-    QCache<qint32, QByteArray> fieldCache;
+    // Memory mapping
+    bool useMemoryMapping;
+    AccessPattern accessPattern;
+    uchar *mappedData;
+    qint64 mappedLength;
+
+    void applyAccessPattern();
+
+    // Read-ahead (window and statistics guarded by prefetchMutex)
+    static constexpr qint32 DEFAULT_PREFETCH_DEPTH = 64;
+    qint32 prefetchDepth;
+    qint64 pageSize;
+    QMutex prefetchMutex;
+    qint32 prefetchStart;
+    qint32 prefetchEnd;
+    PrefetchStatistics prefetchStatistics;
+
+    bool isPrefetchActive();
+    void prefetchFields(qint32 fieldNumber);
+    void adviseWillNeed(qint64 position, qint64 length);
+    void addStallTime(qint64 nanoseconds);
+
+    // Streaming input (window guarded by streamMutex).  The window is a ring
+    // holding fields streamStart to streamEnd - 1, indexed by field number
+    static constexpr qint32 DEFAULT_STREAM_WINDOW = 64;
+    bool isStreamingInput;
+    qint32 streamWindowSize;
+    QMutex streamMutex;
+    QVector<QByteArray> streamWindow;
+    qint32 streamStart;
+    qint32 streamEnd;
+
+    QByteArray getStreamField(qint32 fieldNumber);
+    bool readFromStream(char *buffer, qint64 length);
+
+    // Compressed TBC container (see fieldcompressor.h)
+    bool isCompressed;
+    QVector<qint64> fieldOffsets;
+
+    qint64 getFieldPosition(qint32 fieldNumber);
+    bool readCompressedIndex();
+    bool readCompressedField(qint32 fieldNumber, QByteArray &fieldData);
+
+    // Field caching.  Fields are cached when they are read from the file or
+    // decompressed (fields from a memory mapped raw file are not cached, as
+    // the OS page cache already holds them)
+    static constexpr qint32 DEFAULT_CACHE_SIZE = 128;
+    static qint64 defaultCacheBytes;
+    FieldCache fieldCache;
+
+    // Serialises seek/read where positional reads are unavailable
+    QMutex fileMutex;
+
+    bool readFromFile(qint64 position, char *buffer, qint64 length);
 };
 
 #endif // SOURCEVIDEO_H
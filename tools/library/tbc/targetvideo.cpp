@@ -0,0 +1,170 @@
+/************************************************************************
+
+    targetvideo.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "targetvideo.h"
+
+#include "fieldcompressor.h"
+
+// Class constructor
+TargetVideo::TargetVideo(QObject *parent) : QObject(parent)
+{
+    // Default object settings
+    isTargetVideoOpen = false;
+    fieldByteLength = -1;
+    format = rawFormat;
+    writtenFields = 0;
+    outputPosition = 0;
+}
+
+TargetVideo::~TargetVideo()
+{
+    if (isTargetVideoOpen) close();
+}
+
+// Target Video file manipulation methods -----------------------------------------------------------------------------
+
+// Open an output video data file (returns true on success)
+bool TargetVideo::open(QString filename, qint32 _fieldLength, Format _format)
+{
+    fieldByteLength = _fieldLength * 2;
+    format = _format;
+    qDebug() << "TargetVideo::open(): Called with field byte length =" << fieldByteLength;
+
+    if (isTargetVideoOpen) {
+        qInfo() << "A target video output file is already open, cannot open a new one";
+        return false;
+    }
+
+    // Open the target video file ("-" writes to stdout)
+    bool openSuccess;
+    if (filename == "-") {
+        openSuccess = outputFile.open(stdout, QIODevice::WriteOnly);
+    } else {
+        outputFile.setFileName(filename);
+        openSuccess = outputFile.open(QIODevice::WriteOnly);
+    }
+    if (!openSuccess) {
+        // Failed to open output file
+        qWarning() << "Could not open " << filename << "as target video output file";
+        return false;
+    }
+
+    isTargetVideoOpen = true;
+    writtenFields = 0;
+    outputPosition = 0;
+    fieldOffsets.clear();
+
+    // Write the container header
+    if (format == compressedFormat) {
+        if (!writeData(FieldCompressor::makeHeader(fieldByteLength))) {
+            qWarning() << "Could not write the header to the target video output file";
+            close();
+            return false;
+        }
+        qDebug() << "TargetVideo::open(): Writing compressed TBC output";
+    }
+
+    return true;
+}
+
+// Close an output video data file.  For compressed output this writes the field
+// index, so the output is not valid until this has been called.
+// Returns true on success
+bool TargetVideo::close()
+{
+    if (!isTargetVideoOpen) {
+        qDebug() << "TargetVideo::close(): Called but no target video output file is open";
+        return true;
+    }
+
+    bool success = true;
+    if (format == compressedFormat) {
+        // Write the index (with the end offset of the last field) and the trailer
+        qint64 indexPosition = outputPosition;
+        fieldOffsets.append(outputPosition);
+        if (!writeData(FieldCompressor::makeIndex(fieldOffsets))) success = false;
+        if (!writeData(FieldCompressor::makeTrailer(indexPosition, writtenFields))) success = false;
+        if (!success) qWarning() << "Could not write the field index to the target video output file";
+    }
+
+    outputFile.close();
+    isTargetVideoOpen = false;
+
+    qDebug() << "TargetVideo::close(): Target video output file closed after" << writtenFields << "fields";
+    return success;
+}
+
+// Get the validity of the target video file
+bool TargetVideo::isTargetValid()
+{
+    return isTargetVideoOpen;
+}
+
+// Get the number of fields written to the target video file
+qint32 TargetVideo::getNumberOfWrittenFields()
+{
+    return writtenFields;
+}
+
+// Get the output format
+TargetVideo::Format TargetVideo::getFormat()
+{
+    return format;
+}
+
+// Field data output methods ------------------------------------------------------------------------------------------
+
+// Write the next field to the output (returns true on success)
+bool TargetVideo::writeVideoField(const QByteArray &fieldData)
+{
+    if (!isTargetVideoOpen) qFatal("Application wrote TBC field before opening TBC file - Fatal error");
+
+    if (fieldData.size() != fieldByteLength) {
+        qWarning() << "TargetVideo::writeVideoField(): Field data is" << fieldData.size() << "bytes, expected" << fieldByteLength;
+        return false;
+    }
+
+    if (format == compressedFormat) {
+        // Only index the field once it has been written, so the index never
+        // points at a record that isn't there
+        const qint64 fieldPosition = outputPosition;
+        if (!writeData(FieldCompressor::compressField(fieldData))) return false;
+        fieldOffsets.append(fieldPosition);
+    } else {
+        if (!writeData(fieldData)) return false;
+    }
+
+    writtenFields++;
+    return true;
+}
+
+// Write data to the output file, keeping track of the output position
+bool TargetVideo::writeData(const QByteArray &data)
+{
+    qint64 writtenBytes = outputFile.write(data);
+    if (writtenBytes != data.size()) return false;
+
+    outputPosition += writtenBytes;
+    return true;
+}
@@ -0,0 +1,77 @@
+/************************************************************************
+
+    targetvideo.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 agent
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef TARGETVIDEO_H
+#define TARGETVIDEO_H
+
+#include <QObject>
+#include <QFile>
+#include <QVector>
+#include <QDebug>
+
+// Writer for TBC files, either as raw 16-bit fields or using the compressed
+// TBC container (see fieldcompressor.h).  Fields must be written in
+// sequential order, so the output may be a pipe (use "-" for stdout).
+class TargetVideo : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TargetVideo(QObject *parent = nullptr);
+    ~TargetVideo() override;
+
+    // Output file formats
+    enum Format {
+        rawFormat,
+        compressedFormat
+    };
+
+    // File handling methods
+    bool open(QString filename, qint32 _fieldLength, Format _format = rawFormat);
+    bool close(void);
+
+    // Field handling methods
+    bool writeVideoField(const QByteArray &fieldData);
+
+    // Get and set methods
+    bool isTargetValid();
+    qint32 getNumberOfWrittenFields();
+    Format getFormat();
+
+private:
+    // File handling globals
+    QFile outputFile;
+    bool isTargetVideoOpen;
+    qint32 fieldByteLength;
+    Format format;
+    qint32 writtenFields;
+
+    // Compressed container state
+    qint64 outputPosition;
+    QVector<qint64> fieldOffsets;
+
+    bool writeData(const QByteArray &data);
+};
+
+#endif // TARGETVIDEO_H